@@ -0,0 +1,169 @@
+//+--------------------------------------------------------------------------
+//
+// File:        arena.h
+//
+// NightDriverStrip - (c) 2026 Plummer's Software LLC.  All Rights Reserved.
+//
+// This file is part of the NightDriver software project.
+//
+//    NightDriver is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    NightDriver is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with Nightdriver.  It is normally found in copying.txt
+//    If not, see <https://www.gnu.org/licenses/>.
+//
+// Description:
+//
+//    Bump ("arena") allocator for effect scratch memory.  Every effect has
+//    one (see LEDStripEffect::Arena()), from which it can take the buffers
+//    it sets up in Init().  Allocation is a pointer increment, and it all
+//    goes back to the heap in one go when the effect is released, which
+//    happens when the effect manager moves on to another one.  A handful of
+//    large blocks per effect leaves the heap in a lot better shape after
+//    days of cycling effects than the many small buffers they replace.
+//
+//---------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <vector>
+#include <esp_heap_caps.h>
+
+#include "types.h"
+
+// ArenaMemory
+//
+// Where an arena gets its blocks from.  PreferInternal is for buffers that are touched several times per frame;
+// it falls back to PSRAM when internal RAM runs low.
+
+enum class ArenaMemory
+{
+    PreferPSRAM,
+    PreferInternal
+};
+
+// ScratchArena
+//
+// Hands out aligned chunks of memory by bumping an offset into the current block, and starts a new block when
+// that one is full.  Chunks can't be freed one by one; Reset() (or destroying the arena) releases all of them.
+// Nothing is allocated until the first chunk is asked for.  Destructors are never run, so this is meant for
+// plain data.
+
+class ScratchArena
+{
+    std::vector<uint8_t *> _blocks;
+    size_t       _blockSize;
+    size_t       _lastBlockSize = 0;
+    size_t       _offset        = 0;            // Bytes used in the last block
+    size_t       _bytesAllocated = 0;           // Total size of all blocks
+    ArenaMemory  _memory;
+
+    uint8_t * NewBlock(size_t size)
+    {
+        void * p = nullptr;
+
+        if (_memory == ArenaMemory::PreferInternal)
+            p = heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+
+        if (!p)
+            p = TryPreferPSRAMAlloc(size);
+
+        if (!p)
+            return nullptr;
+
+        _blocks.push_back(static_cast<uint8_t *>(p));
+        _lastBlockSize = size;
+        _offset = 0;
+        _bytesAllocated += size;
+
+        return _blocks.back();
+    }
+
+  public:
+
+    explicit ScratchArena(ArenaMemory memory, size_t blockSize = EFFECT_ARENA_BLOCK_SIZE)
+      : _blockSize(blockSize),
+        _memory(memory)
+    {
+    }
+
+    ~ScratchArena()
+    {
+        Reset();
+    }
+
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    // Allocate
+    //
+    // Returns a chunk of at least 'size' bytes with the requested alignment, or nullptr if there's no memory left.
+
+    void * Allocate(size_t size, size_t alignment = alignof(std::max_align_t))
+    {
+        size_t start = (_offset + alignment - 1) & ~(alignment - 1);
+
+        if (_blocks.empty() || start + size > _lastBlockSize)
+        {
+            // Blocks come from malloc, so they're aligned well enough for anything; big requests get a block to themselves
+            if (!NewBlock(std::max(_blockSize, size)))
+                return nullptr;
+
+            start = 0;
+        }
+
+        _offset = start + size;
+        return _blocks.back() + start;
+    }
+
+    // Allocate<T>
+    //
+    // Returns an array of 'count' value-initialized (so, for numbers, zeroed) objects of type T, or nullptr if
+    // there's no memory left.
+
+    template<typename T>
+    T * Allocate(size_t count)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "Arena memory is released without running destructors");
+
+        T * p = static_cast<T *>(Allocate(count * sizeof(T), alignof(T)));
+        if (!p)
+            return nullptr;
+
+        for (size_t i = 0; i < count; i++)
+            new (p + i) T();
+
+        return p;
+    }
+
+    // Releases everything that was allocated from the arena
+    void Reset()
+    {
+        for (auto pBlock : _blocks)
+            free(pBlock);
+
+        _blocks.clear();
+        _lastBlockSize = 0;
+        _offset = 0;
+        _bytesAllocated = 0;
+    }
+
+    size_t BytesAllocated() const
+    {
+        return _bytesAllocated;
+    }
+};
@@ -30,6 +30,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <vector>
 #include <tuple>
 #include "jsonserializer.h"
@@ -131,6 +132,7 @@ class DeviceConfig : public IJSONSerializable
     bool    useCelsius = false;
     String  ntpServer = NTP_SERVER_DEFAULT;
     bool    rememberCurrentEffect = true;
+    bool    syncEffects = false;
     int     powerLimit = POWER_LIMIT_DEFAULT;
     bool    showVUMeter = true;
     uint8_t brightness = BRIGHTNESS_MAX;
@@ -141,6 +143,7 @@ class DeviceConfig : public IJSONSerializable
     std::vector<SettingSpec, psram_allocator<SettingSpec>> settingSpecs;
     std::vector<std::reference_wrapper<SettingSpec>> settingSpecReferences;
     size_t writerIndex;
+    mutable std::atomic<uint32_t> revision = 1;     // Bumped by SaveToJSON(), so whenever a setting changes
 
     void SaveToJSON() const;
 
@@ -177,6 +180,7 @@ class DeviceConfig : public IJSONSerializable
     static constexpr const char * UseCelsiusTag = NAME_OF(useCelsius);
     static constexpr const char * NTPServerTag = NAME_OF(ntpServer);
     static constexpr const char * RememberCurrentEffectTag = NAME_OF(rememberCurrentEffect);
+    static constexpr const char * SyncEffectsTag = NAME_OF(syncEffects);
     static constexpr const char * PowerLimitTag = NAME_OF(powerLimit);
     static constexpr const char * BrightnessTag = NAME_OF(brightness);
     // No need to publish the show VU meter tag unless we're also publishing the setting
@@ -209,6 +213,7 @@ class DeviceConfig : public IJSONSerializable
         jsonDoc[UseCelsiusTag] = useCelsius;
         jsonDoc[NTPServerTag] = ntpServer;
         jsonDoc[RememberCurrentEffectTag] = rememberCurrentEffect;
+        jsonDoc[SyncEffectsTag] = syncEffects;
         jsonDoc[PowerLimitTag] = powerLimit;
         // Only serialize showVUMeter if the VU meter is enabled in the build
         #if SHOW_VU_METER
@@ -246,6 +251,7 @@ class DeviceConfig : public IJSONSerializable
         SetIfPresentIn(jsonObject, useCelsius, UseCelsiusTag);
         SetIfPresentIn(jsonObject, ntpServer, NTPServerTag);
         SetIfPresentIn(jsonObject, rememberCurrentEffect, RememberCurrentEffectTag);
+        SetIfPresentIn(jsonObject, syncEffects, SyncEffectsTag);
         SetIfPresentIn(jsonObject, powerLimit, PowerLimitTag);
         SetIfPresentIn(jsonObject, brightness, BrightnessTag);
         // Only deserialize showVUMeter if the VU meter is enabled in the build
@@ -273,6 +279,12 @@ class DeviceConfig : public IJSONSerializable
         RemoveJSONFile(DEVICE_CONFIG_FILE);
     }
 
+    // Returns a number that changes whenever any of the settings does
+    uint32_t GetRevision() const
+    {
+        return revision;
+    }
+
     virtual const std::vector<std::reference_wrapper<SettingSpec>>& GetSettingSpecs()
     {
         if (settingSpecs.empty())
@@ -346,6 +358,14 @@ class DeviceConfig : public IJSONSerializable
                 "from the same effect when restarted. Enabling this will lead to more wear on the flash chip of your device.",
                 SettingSpec::SettingType::Boolean
             );
+            settingSpecs.emplace_back(
+                SyncEffectsTag,
+                "Synchronize effects",
+                "Indicates if effect changes should follow the wall clock, so that devices with this enabled switch effects "
+                "at the same moments and start them with the same random seed. Devices only line up if they have the same "
+                "effect list and interval, and their clock has been set using NTP.",
+                SettingSpec::SettingType::Boolean
+            );
             settingSpecs.emplace_back(
                 BrightnessTag,
                 "Brightness",
@@ -507,6 +527,16 @@ class DeviceConfig : public IJSONSerializable
         SetAndSave(rememberCurrentEffect, newRememberCurrentEffect);
     }
 
+    bool SyncEffects() const
+    {
+        return syncEffects;
+    }
+
+    void SetSyncEffects(bool newSyncEffects)
+    {
+        SetAndSave(syncEffects, newSyncEffects);
+    }
+
     uint8_t GetBrightness() const
     {
         return brightness;
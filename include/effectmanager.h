@@ -38,6 +38,7 @@
 #include <set>
 #include <algorithm>
 #include <functional>
+#include <mutex>
 #include <math.h>
 
 #include "effectfactories.h"
@@ -99,13 +100,131 @@ public:
     }
 };
 
+// Buffer holding an effect's JSON configuration packed as MessagePack
+using PackedEffectConfig = std::vector<uint8_t, psram_allocator<uint8_t>>;
+
+// EffectEntry
+//
+// One slot in the effect list.  Only the effect that is playing (and possibly the one that's up next) is
+// kept as a live LEDStripEffect object; every other slot holds just the effect number, name, flags and its
+// JSON configuration packed as MessagePack.  Load() instantiates the effect from that configuration using
+// the effect's JSON factory, and Unload() packs its current configuration back up and releases the object.
+
+class EffectEntry
+{
+    int    _effectNumber;
+    String _friendlyName;
+    bool   _enabled    = true;
+    bool   _coreEffect = false;
+
+    mutable PackedEffectConfig _serialized;
+    mutable std::shared_ptr<LEDStripEffect> _effect;
+    mutable bool _initialized = false;
+
+  public:
+
+    // Wraps an effect that has already been constructed, and possibly initialized; it stays loaded until
+    // Unload() is called
+    EffectEntry(const std::shared_ptr<LEDStripEffect>& effect, bool initialized)
+      : _effectNumber(effect->EffectNumber()),
+        _friendlyName(effect->FriendlyName()),
+        _enabled(effect->IsEnabled()),
+        _coreEffect(effect->IsCoreEffect()),
+        _effect(effect),
+        _initialized(initialized)
+    {}
+
+    // Creates an unloaded entry from a serialized effect object, as found in the effects config file
+    explicit EffectEntry(const JsonObjectConst& jsonObject)
+      : _effectNumber(jsonObject[PTY_EFFECTNR]),
+        _friendlyName(jsonObject["fn"].as<String>()),
+        _coreEffect(jsonObject[PTY_COREEFFECT].as<int>() != 0)
+    {
+        if (jsonObject["es"].is<int>())
+            _enabled = jsonObject["es"].as<int>() == 1;
+
+        _serialized.resize(measureMsgPack(jsonObject));
+        serializeMsgPack(jsonObject, _serialized.data(), _serialized.size());
+    }
+
+    int EffectNumber() const
+    {
+        return _effectNumber;
+    }
+
+    // The name is read from the live effect if it's loaded, as its settings may have changed it. That means this
+    //   must be called with the effect manager's _effectLoadMutex held; other tasks can use GetEffectName().
+    String FriendlyName() const
+    {
+        return _effect ? _effect->FriendlyName() : _friendlyName;
+    }
+
+    // The enabled flag is only ever changed through SetEnabled(), so our own copy is always up to date
+    bool IsEnabled() const
+    {
+        return _enabled;
+    }
+
+    // Changes the enabled flag of the effect, or of its packed configuration if it's not loaded. The latter is
+    // rebuilt in place, so this must be called with the effect manager's _effectLoadMutex held.
+    // Implementation is in effectmanager.cpp.
+    void SetEnabled(bool enabled);
+
+    bool IsCoreEffect() const
+    {
+        return _coreEffect;
+    }
+
+    bool IsLoaded() const
+    {
+        return _effect != nullptr;
+    }
+
+    // Returns the live effect, constructing it from its serialized configuration first if needed, but without
+    // initializing it. Returns nullptr if the effect can't be created. Implementation is in effectmanager.cpp.
+    std::shared_ptr<LEDStripEffect> Instantiate() const;
+
+    // Returns a copy of the packed configuration, which is empty while the effect is loaded. Together with the
+    // effect number and core flag, that's all Construct() needs, so the effect can be constructed without
+    // holding the effect manager's _effectLoadMutex (or a reference to the entry, which may move meanwhile).
+    PackedEffectConfig PackedConfig() const
+    {
+        return _serialized;
+    }
+
+    // Constructs an effect from a packed configuration, without initializing it. Returns nullptr if it can't be
+    // created. Implementation is in effectmanager.cpp.
+    static std::shared_ptr<LEDStripEffect> Construct(int effectNumber, bool coreEffect, const PackedEffectConfig& config);
+
+    // Makes an effect built by Construct() the live effect, provided the entry still holds the configuration it
+    // was built from and isn't loaded yet. Returns false otherwise. Must be called with the effect manager's
+    // _effectLoadMutex held. Implementation is in effectmanager.cpp.
+    bool Adopt(const std::shared_ptr<LEDStripEffect>& effect, const PackedEffectConfig& config) const;
+
+    // Returns the live effect, instantiating and initializing it first if needed. Effects are free to draw on
+    // the devices in Init(), so this should only be called on the draw task. Returns nullptr if the effect can't
+    // be created or fails to initialize. Implementation is in effectmanager.cpp.
+    std::shared_ptr<LEDStripEffect> Load(const std::vector<std::shared_ptr<GFXBase>>& gfx) const;
+
+    // Serializes the live effect and releases it. Effects that can't be serialized, don't have a JSON
+    // factory or are still referenced elsewhere (by the web server, for instance) are left loaded.
+    // Implementation is in effectmanager.cpp.
+    void Unload();
+
+    // Writes the effect's configuration to JSON, whether it's currently loaded or not
+    bool SerializeToJSON(JsonObject& jsonObject) const;
+
+    // Writes the effect's configuration as MessagePack, whether it's currently loaded or not
+    bool SerializeToMsgPack(PackedEffectConfig& buffer) const;
+};
+
 // EffectManager
 //
 // Handles keeping track of the effects, which one is active, asking it to draw, etc.
 
 class  EffectManager : public IJSONSerializable
 {
-    std::vector<std::shared_ptr<LEDStripEffect>> _vEffects;
+    std::vector<EffectEntry> _vEffects;
 
     size_t _iCurrentEffect = 0;
     uint _effectStartTime;
@@ -115,8 +234,36 @@ class  EffectManager : public IJSONSerializable
     std::atomic_bool _newFrameAvailable = false;
     int _effectSetVersion = 1;
 
+    // Effects are loaded and unloaded both by the draw task and the prefetch task, so that's done under this mutex
+    mutable std::mutex _effectLoadMutex;
+    std::atomic<size_t> _iPrefetchEffect = SIZE_MAX;
+    bool _prefetchRequested = false;
+
+    // When effects are synchronized, the interval-sized slot of wall clock time the current effect was started for
+    uint64_t _syncSlot = UINT64_MAX;
+
+    // Frame hash recording (see effectsources.h). Requests and results are handed over under the mutex; the
+    //   recording itself is done on the draw task, using the members that follow.
+    mutable std::mutex _recordingMutex;
+    std::shared_ptr<FrameHashRecording> _requestedRecording;
+    std::shared_ptr<const FrameHashRecording> _lastRecording;
+    std::atomic_bool _recordingActive = false;
+    std::shared_ptr<FrameHashRecording> _recording;
+    std::shared_ptr<LEDStripEffect> _recordingEffect;
+    std::shared_ptr<ReplayEffectSources> _replaySources;
+
     std::vector<std::shared_ptr<GFXBase>> _gfx;
     std::shared_ptr<LEDStripEffect> _tempEffect;
+
+    // The regular effect that StartEffect() loaded, or the blank effect if none could be. Both are only swapped on
+    //   the draw task, under _effectLoadMutex.
+    std::shared_ptr<LEDStripEffect> _currentEffect;
+    std::shared_ptr<LEDStripEffect> _blankEffect;
+
+    // Properties of the effect that's showing, for tasks other than the draw task, which mustn't touch the effect
+    //   itself. Refreshed by CacheCurrentEffectProperties().
+    std::atomic<uint> _currentMaximumEffectTime = std::numeric_limits<uint>::max();
+    std::atomic_bool _currentCanDisplayVUMeter = false;
     std::vector<std::reference_wrapper<IFrameEventListener>> _frameEventListeners;
     std::vector<std::reference_wrapper<IEffectEventListener>> _effectEventListeners;
 
@@ -147,16 +294,95 @@ class  EffectManager : public IJSONSerializable
         {
             // Effects in the default list are core effects. These can be disabled but not deleted.
             pEffect->MarkAsCoreEffect();
-            _vEffects.push_back(pEffect);
+
+            // We only need the effect's configuration until it's actually played
+            auto& entry = _vEffects.emplace_back(pEffect, false);
+            pEffect.reset();
+            entry.Unload();
+        }
+    }
+
+    // Instantiates the current effect if it isn't loaded yet. If it can't be loaded (usually for lack of memory), we
+    //   move on to the next one for now. The effect is left enabled, so it gets another go the next time around.
+    //   Returns nullptr if no effect at all can be loaded. Must be called with _effectLoadMutex held.
+    std::shared_ptr<LEDStripEffect> LoadCurrentEffect()
+    {
+        for (size_t attempt = 0; attempt < EffectCount(); attempt++)
+        {
+            auto effect = _vEffects[_iCurrentEffect].Load(_gfx);
+            if (effect)
+                return effect;
+
+            debugE("Could not load effect %s, skipping it", _vEffects[_iCurrentEffect].FriendlyName().c_str());
+
+            _iCurrentEffect = GetNextEffectIndex();
         }
+
+        return nullptr;
     }
 
+    // Creates the effect that's shown when no other one can be. Implementation is in effectmanager.cpp.
+    void CreateBlankEffect();
+
+    void CacheCurrentEffectProperties()
+    {
+        auto& effect = GetCurrentEffect();
+
+        _currentMaximumEffectTime = effect.HasMaximumEffectTime() ? effect.MaximumEffectTime() : std::numeric_limits<uint>::max();
+        _currentCanDisplayVUMeter = effect.CanDisplayVUMeter();
+    }
+
+    // Releases all effect objects except the one we're playing. Must be called with _effectLoadMutex held.
+    void UnloadInactiveEffects()
+    {
+        for (size_t i = 0; i < _vEffects.size(); i++)
+        {
+            if (i != _iCurrentEffect && _vEffects[i].IsLoaded())
+                _vEffects[i].Unload();
+        }
+    }
+
+    // Asks the prefetch task to load the next effect once the current one is about to end.
+    //   Implementation is in effectmanager.cpp.
+    void CheckPrefetchNextEffect();
+
+    // Draws the next frame of a frame hash recording, if one has been requested. Returns true if it did, in which
+    //   case the regular effect should not be drawn. Implementations are in effectmanager.cpp.
+    bool UpdateFrameHashRecording();
+    void FinishFrameHashRecording();
+
+    // Synchronized playback; see CheckSyncedEffectTimer(). Implementations are in effectmanager.cpp.
+    bool IsPlaybackSynced() const;
+    size_t GetSyncedEffectIndex(uint64_t slot) const;
+    void CheckSyncedEffectTimer();
+
     // Implementation is in effects.cpp
     void LoadJSONAndMissingEffects(const JsonArrayConst& effectsArray);
 
     static void SaveCurrentEffectIndex();
     static bool ReadCurrentEffectIndex(size_t& index);
 
+    // Moves an entry in the effect list, keeping _iCurrentEffect pointed at the effect that's playing. Must be called
+    //   with _effectLoadMutex held. Returns true if the current effect index changed.
+    bool MoveEntry(size_t from, size_t to)
+    {
+        if (from < to)
+            std::rotate(_vEffects.begin() + from, _vEffects.begin() + from + 1, _vEffects.begin() + to + 1);
+        else // from > to
+            std::rotate(_vEffects.rend() - from - 1, _vEffects.rend() - from, _vEffects.rend() - to);
+
+        if (from == _iCurrentEffect)
+            _iCurrentEffect = to;
+        else if (from < _iCurrentEffect && to >= _iCurrentEffect)
+            _iCurrentEffect--;
+        else if (from > _iCurrentEffect && to <= _iCurrentEffect)
+            _iCurrentEffect++;
+        else
+            return false;
+
+        return true;
+    }
+
     void ClearEffects()
     {
         _vEffects.clear();
@@ -171,6 +397,8 @@ public:
     {
         debugV("EffectManager Splash Effect Constructor");
 
+        CreateBlankEffect();
+
         if (effect->Init(_gfx))
             _tempEffect = effect;
 
@@ -182,6 +410,7 @@ public:
     {
         debugV("EffectManager Constructor");
 
+        CreateBlankEffect();
         LoadDefaultEffects();
     }
 
@@ -190,6 +419,7 @@ public:
     {
         debugV("EffectManager JSON Constructor");
 
+        CreateBlankEffect();
         DeserializeFromJSON(jsonObject);
     }
 
@@ -336,16 +566,54 @@ public:
 
         JsonArray effectsArray = jsonObject["efs"].to<JsonArray>();
 
-        for (auto & effect : _vEffects)
+        std::lock_guard<std::mutex> guard(_effectLoadMutex);
+
+        for (auto & entry : _vEffects)
         {
             JsonObject effectObject = effectsArray.add<JsonObject>();
-            if (!(effect->SerializeToJSON(effectObject)))
+            if (!(entry.SerializeToJSON(effectObject)))
+                return false;
+        }
+
+        return true;
+    }
+
+    // PackEffectConfigs
+    //
+    // Packs the configuration of every effect in the list as MessagePack, for the binary effect config store
+    // (see effectstore.h). The store persists the rest of what SerializeToJSON() writes separately.
+
+    bool PackEffectConfigs(std::vector<PackedEffectConfig>& packedConfigs) const
+    {
+        std::lock_guard<std::mutex> guard(_effectLoadMutex);
+
+        packedConfigs.resize(_vEffects.size());
+
+        for (size_t i = 0; i < _vEffects.size(); i++)
+        {
+            if (!_vEffects[i].SerializeToMsgPack(packedConfigs[i]))
                 return false;
         }
 
         return true;
     }
 
+    int GetEffectSetVersion() const
+    {
+        return _effectSetVersion;
+    }
+
+    // Serializes a single effect in the list, for responses that are sent one effect at a time
+    bool SerializeEffectToJSON(size_t index, JsonObject& jsonObject) const
+    {
+        std::lock_guard<std::mutex> guard(_effectLoadMutex);
+
+        if (index >= _vEffects.size())
+            return false;
+
+        return _vEffects[index].SerializeToJSON(jsonObject);
+    }
+
     // Must provide at least one drawing instance, like the first matrix or strip we are drawing on
     inline std::shared_ptr<GFXBase> g(int iChannel = 0) const
     {
@@ -371,7 +639,26 @@ public:
         // If there's a temporary effect override from the remote control active, we start that, else
         // we start the current regular effect
 
-        std::shared_ptr<LEDStripEffect> & effect = _tempEffect ? _tempEffect : _vEffects[_iCurrentEffect];
+        std::lock_guard<std::mutex> guard(_effectLoadMutex);
+
+        // If the prefetch task hasn't picked up its request yet, it doesn't need to anymore
+        _iPrefetchEffect = SIZE_MAX;
+        _prefetchRequested = false;
+
+        std::shared_ptr<LEDStripEffect> effect = _tempEffect;
+
+        if (!effect)
+        {
+            _currentEffect = LoadCurrentEffect();
+
+            if (!_currentEffect)
+            {
+                debugE("Could not load any effect, showing a blank frame");
+                _currentEffect = _blankEffect;
+            }
+
+            effect = _currentEffect;
+        }
 
         #if USE_HUB75
             auto pMatrix = std::static_pointer_cast<LEDMatrixGFX>(_gfx[0]);
@@ -380,6 +667,12 @@ public:
 
         effect->Start();
         _effectStartTime = millis();
+
+        CacheCurrentEffectProperties();
+
+        // Only the effect we just started needs to stay around (which may well be the one that was prefetched)
+        if (!_tempEffect)
+            UnloadInactiveEffects();
     }
 
     void EnableEffect(size_t i, bool skipSave = false)
@@ -390,14 +683,17 @@ public:
             return;
         }
 
-        auto& effect = _vEffects[i];
+        auto& entry = _vEffects[i];
 
-        if (!effect->IsEnabled())
+        if (!entry.IsEnabled())
         {
             if (!AreEffectsEnabled())
                 ClearRemoteColor(true);
 
-            effect->SetEnabled(true);
+            {
+                std::lock_guard<std::mutex> guard(_effectLoadMutex);
+                entry.SetEnabled(true);
+            }
 
             if (!skipSave)
                 SaveEffectManagerConfig();
@@ -414,11 +710,14 @@ public:
             return;
         }
 
-        auto effect = _vEffects[i];
+        auto& entry = _vEffects[i];
 
-        if (effect->IsEnabled())
+        if (entry.IsEnabled())
         {
-            effect->SetEnabled(false);
+            {
+                std::lock_guard<std::mutex> guard(_effectLoadMutex);
+                entry.SetEnabled(false);
+            }
 
             if (!AreEffectsEnabled())
                 ApplyGlobalColor(CRGB::Black);
@@ -430,6 +729,18 @@ public:
         }
     }
 
+    String GetEffectName(size_t i) const
+    {
+        std::lock_guard<std::mutex> guard(_effectLoadMutex);
+
+        if (i >= _vEffects.size())
+        {
+            debugW("Invalid index for GetEffectName");
+            return "";
+        }
+        return _vEffects[i].FriendlyName();
+    }
+
     bool IsEffectEnabled(size_t i) const
     {
         if (i >= _vEffects.size())
@@ -437,7 +748,7 @@ public:
             debugW("Invalid index for IsEffectEnabled");
             return false;
         }
-        return _vEffects[i]->IsEnabled();
+        return _vEffects[i].IsEnabled();
     }
 
     void MoveEffect(size_t from, size_t to)
@@ -450,32 +761,43 @@ public:
 
         if (from == to)
             return;
-        else if (from < to)
-            std::rotate(_vEffects.begin() + from, _vEffects.begin() + from + 1, _vEffects.begin() + to + 1);
-        else // from > to
-            std::rotate(_vEffects.rend() - from - 1, _vEffects.rend() - from, _vEffects.rend() - to);
 
-        if (from == _iCurrentEffect)
-        {
-            _iCurrentEffect = to;
-            SaveCurrentEffectIndex();
-        }
-        else if (from < _iCurrentEffect && to >= _iCurrentEffect)
+        bool currentEffectMoved;
+
         {
-            _iCurrentEffect--;
-            SaveCurrentEffectIndex();
+            // Entries must not be moved while the prefetch task is loading one of them
+            std::lock_guard<std::mutex> guard(_effectLoadMutex);
+            currentEffectMoved = MoveEntry(from, to);
         }
-        else if (from > _iCurrentEffect && to <= _iCurrentEffect)
-        {
-            _iCurrentEffect++;
+
+        if (currentEffectMoved)
             SaveCurrentEffectIndex();
-        }
 
         SaveEffectManagerConfig();
 
         INFORM_EVENT_LISTENERS(_effectEventListeners, IEffectEventListener::OnEffectListDirty);
     }
 
+    // One change to the effect list, as applied by ApplyEffectListOperations()
+    struct EffectListOperation
+    {
+        enum class Type
+        {
+            Enable,
+            Disable,
+            Move
+        };
+
+        Type   type;
+        size_t index;
+        size_t newIndex = 0;        // Only used by Move
+    };
+
+    // Applies a list of changes to the effect list in one go: either all of them are applied or, if any of them is
+    //   invalid, none are. Listeners are informed and the configuration is saved once, after the last change.
+    //   Implementation is in effectmanager.cpp.
+    bool ApplyEffectListOperations(const std::vector<EffectListOperation>& operations);
+
     // Creates a copy of an existing effect in the list. Note that the effect is created but not yet added to the effect list;
     //   use the AppendEffect() function for that.
     std::shared_ptr<LEDStripEffect> CopyEffect(size_t index);
@@ -487,9 +809,20 @@ public:
         if (!effect->Init(_gfx))
             return false;
 
-        _vEffects.push_back(effect);
+        {
+            std::lock_guard<std::mutex> guard(_effectLoadMutex);
+            _vEffects.emplace_back(effect, true);
+        }
+
         EnableEffect(_vEffects.size() - 1, true);
 
+        // The effect isn't played right away, so there's no need to keep it in memory
+        if (_vEffects.size() - 1 != _iCurrentEffect)
+        {
+            std::lock_guard<std::mutex> guard(_effectLoadMutex);
+            _vEffects.back().Unload();
+        }
+
         SaveEffectManagerConfig();
 
         INFORM_EVENT_LISTENERS(_effectEventListeners, IEffectEventListener::OnEffectListDirty);
@@ -506,7 +839,7 @@ public:
         }
 
         // We don't allow core effects to be deleted
-        if (_vEffects[index]->IsCoreEffect())
+        if (_vEffects[index].IsCoreEffect())
             return false;
 
         DisableEffect(index, true);
@@ -514,7 +847,10 @@ public:
         if (index == _iCurrentEffect)
             NextEffect();
 
-        _vEffects.erase(_vEffects.begin() + index);
+        {
+            std::lock_guard<std::mutex> guard(_effectLoadMutex);
+            _vEffects.erase(_vEffects.begin() + index);
+        }
 
         if (index <= _iCurrentEffect)
         {
@@ -548,11 +884,27 @@ public:
         INFORM_EVENT_LISTENERS(_effectEventListeners, IEffectEventListener::OnIntervalChanged, interval);
     }
 
-    const std::vector<std::shared_ptr<LEDStripEffect>> & EffectsList() const
+    // Note that most entries in the effect list are not loaded; use GetEffect() to get to the effect itself
+    const std::vector<EffectEntry> & EffectsList() const
     {
         return _vEffects;
     }
 
+    // Returns the effect at the given index, creating it if necessary. Returns nullptr if the index is out
+    //   of range or the effect can't be created. This can be called from any task, so the effect is not
+    //   initialized here; that's left to the draw task, for when the effect is played.
+    std::shared_ptr<LEDStripEffect> GetEffect(size_t index) const
+    {
+        if (index >= _vEffects.size())
+        {
+            debugW("Invalid index for GetEffect");
+            return nullptr;
+        }
+
+        std::lock_guard<std::mutex> guard(_effectLoadMutex);
+        return _vEffects[index].Instantiate();
+    }
+
     size_t EffectCount() const
     {
         return _vEffects.size();
@@ -560,7 +912,7 @@ public:
 
     bool AreEffectsEnabled() const
     {
-        return std::any_of(_vEffects.begin(), _vEffects.end(), [](const auto& pEffect){ return pEffect->IsEnabled(); } );
+        return std::any_of(_vEffects.begin(), _vEffects.end(), [](const auto& entry){ return entry.IsEnabled(); } );
     }
 
     size_t GetCurrentEffectIndex() const
@@ -568,17 +920,24 @@ public:
         return _iCurrentEffect;
     }
 
+    // Returns the effect that's showing. The regular effect is only replaced by StartEffect(), so the reference
+    //   is only good on the draw task; other tasks should go by GetEffectiveInterval() and IsVUVisible().
     LEDStripEffect& GetCurrentEffect() const
     {
-        return *(_tempEffect ? _tempEffect : _vEffects[_iCurrentEffect]);
+        if (_tempEffect)
+            return *_tempEffect;
+
+        return _currentEffect ? *_currentEffect : *_blankEffect;
     }
 
-    const String & GetCurrentEffectName() const
+    String GetCurrentEffectName() const
     {
+        std::lock_guard<std::mutex> guard(_effectLoadMutex);
+
         if (_tempEffect)
             return _tempEffect->FriendlyName();
 
-        return _vEffects[_iCurrentEffect]->FriendlyName();
+        return _vEffects[_iCurrentEffect].FriendlyName();
     }
 
     // Change the current effect; marks the state as needing attention so this get noticed next frame
@@ -596,7 +955,8 @@ public:
         StartEffect();
         SaveCurrentEffectIndex();
 
-        INFORM_EVENT_LISTENERS(_effectEventListeners, IEffectEventListener::OnCurrentEffectChanged, i);
+        // StartEffect() may have skipped ahead, if effect i couldn't be loaded
+        INFORM_EVENT_LISTENERS(_effectEventListeners, IEffectEventListener::OnCurrentEffectChanged, _iCurrentEffect);
     }
 
     uint GetTimeUsedByCurrentEffect() const
@@ -613,12 +973,12 @@ public:
         return timeUsedByCurrentEffect > interval ? 0 : (interval - timeUsedByCurrentEffect);
     }
 
+    // This allows you to return a MaximumEffectTime and your effect won't be shown longer than that. The web server
+    //   calls this too, so it goes by the maximum time cached on the draw task rather than asking the effect.
     uint GetEffectiveInterval() const
     {
-        auto& currentEffect = GetCurrentEffect();
-        // This allows you to return a MaximumEffectTime and your effect won't be shown longer than that
         return min((IsIntervalEternal() ? std::numeric_limits<uint>::max() : _effectInterval),
-                   (currentEffect.HasMaximumEffectTime() ? currentEffect.MaximumEffectTime() : std::numeric_limits<uint>::max()));
+                   _currentMaximumEffectTime.load());
     }
 
     uint GetInterval() const
@@ -633,9 +993,22 @@ public:
 
     void CheckEffectTimerExpired()
     {
+        // Done every frame, so changes to the settings of the effect that's showing, or a switch to or from a
+        //   temporary effect, are picked up
+        CacheCurrentEffectProperties();
+
+        // When effects are synchronized with other devices, the wall clock decides what plays when
+        if (IsPlaybackSynced())
+        {
+            CheckSyncedEffectTimer();
+            return;
+        }
+
+        _syncSlot = UINT64_MAX;
+
         // If interval is zero, the current effect never expires unless it has a max effect time set
 
-        if (IsIntervalEternal() && !GetCurrentEffect().HasMaximumEffectTime())
+        if (GetEffectiveInterval() == std::numeric_limits<uint>::max())
             return;
 
         if (GetTimeUsedByCurrentEffect() >= GetEffectiveInterval()) // See if it's time for a new effect yet
@@ -662,18 +1035,28 @@ public:
     {
         g()->CyclePalette(-1);
     }
-    // Update to the next effect and abort the current effect.
+    // Returns the index of the effect that NextEffect() would move to, without actually moving there
 
-    void NextEffect(bool skipSave = false)
+    size_t GetNextEffectIndex() const
     {
         auto enabled = AreEffectsEnabled();
+        size_t iNextEffect = _iCurrentEffect;
 
         do
         {
-            _iCurrentEffect++; //   ... if so advance to next effect
-            _iCurrentEffect %= EffectCount();
-            _effectStartTime = millis();
-        } while (enabled && false == _bPlayAll && false == IsEffectEnabled(_iCurrentEffect));
+            iNextEffect++;
+            iNextEffect %= EffectCount();
+        } while (enabled && false == _bPlayAll && false == IsEffectEnabled(iNextEffect) && iNextEffect != _iCurrentEffect);
+
+        return iNextEffect;
+    }
+
+    // Update to the next effect and abort the current effect.
+
+    void NextEffect(bool skipSave = false)
+    {
+        _iCurrentEffect = GetNextEffectIndex(); //   ... advance to next effect
+        _effectStartTime = millis();
 
         StartEffect();
         SaveCurrentEffectIndex();
@@ -704,6 +1087,23 @@ public:
 
     bool Init();
 
+    // Asks for a fresh instance of an effect to be replayed with ReplayEffectSources, recording the hash of every
+    //   frame it draws. The display shows the replay while it runs. Implementation is in effectmanager.cpp.
+    bool RequestFrameHashRecording(size_t effectIndex, uint32_t seed, size_t frameCount);
+
+    // Returns the last completed frame hash recording (if any), and whether another one is still underway
+    std::shared_ptr<const FrameHashRecording> GetFrameHashRecording(bool& pending) const
+    {
+        std::lock_guard<std::mutex> guard(_recordingMutex);
+
+        pending = _requestedRecording || _recordingActive;
+        return _lastRecording;
+    }
+
+    // Loads the effect that was requested by CheckPrefetchNextEffect(), if any. This is called by the prefetch task.
+    //   Implementation is in effectmanager.cpp.
+    void PrefetchEffect();
+
     // EffectManager::Update
     //
     // Draws the current effect.  If gUIDirty has been set by an interrupt handler, it is reset here
@@ -715,14 +1115,23 @@ public:
 
         constexpr auto msFadeTime = EFFECT_CROSS_FADE_TIME;
 
+        // A frame hash recording takes over the display until it's done
+        if (UpdateFrameHashRecording())
+            return;
+
         CheckEffectTimerExpired();
 
+        #if EFFECT_PREFETCH
+            if (!_tempEffect)
+                CheckPrefetchNextEffect();
+        #endif
+
         // If a remote control effect is set, we draw that, otherwise we draw the regular effect
 
         if (_tempEffect)
             _tempEffect->Draw();
         else
-            _vEffects[_iCurrentEffect]->Draw(); // Draw the currently active effect
+            GetCurrentEffect().Draw(); // Draw the currently active effect
 
         // If we do indeed have multiple effects (BUGBUG what if only a single enabled?) then we
         // fade in and out at the appropriate time based on the time remaining/used by the effect
@@ -66,8 +66,12 @@
 
 #pragma once
 
+#include <vector>
+
 #include "Vector.h"
 
+class BoidGrid;
+
 //
 // This file defines the class `Boid`, which models the behavior of a boid (bird-like object) in a flock.
 // It includes properties such as location, velocity, acceleration, max speed, and steering force.
@@ -84,6 +88,10 @@
 // There are methods for computing the forces applied to each boid (`flock`, `separate`, `align`, `cohesion`, 
 // `seek`, `arrive`), and for handling border behavior (`wrapAroundBorders`, `avoidBorders`).
 //
+// The array versions of `flock` and friends compare every boid against every other one, which is fine for a
+// handful of boids.  Larger flocks should build a `BoidGrid` once per frame and use the grid overloads (or just
+// call `FlockBoids`), which only look at boids in neighboring grid cells.
+//
 // The boid's properties and behaviors make it suitable for creating simulations of flocking behavior in a 2D space.
 //
 
@@ -128,6 +136,11 @@ class Boid
       // render();
     }
 
+    void run(const BoidGrid& grid) {
+      flock(grid);
+      update();
+    }
+
     // Method to update location
     void update() {
       // Update velocity
@@ -194,6 +207,10 @@ class Boid
       applyForce(coh);
     }
 
+    // Same three rules, but using a spatial grid of the flock so that only nearby boids are visited, and
+    // accumulating separation, alignment and cohesion in a single pass over them
+    void flock(const BoidGrid& grid);
+
     // Separation
     // Method checks for nearby boids and steers away
     PVector separate(Boid boids [], uint8_t boidCount) {
@@ -201,7 +218,7 @@ class Boid
       int count = 0;
       // For every boid in the system, check if it's too close
       for (int i = 0; i < boidCount; i++) {
-        Boid other = boids[i];
+        const Boid& other = boids[i];
         if (!other.enabled)
           continue;
         float d = location.dist(other.location);
@@ -215,6 +232,10 @@ class Boid
           count++;            // Keep track of how many
         }
       }
+      return separationSteer(steer, count);
+    }
+
+    PVector separationSteer(PVector steer, int count) const {
       // Average -- divide by how many
       if (count > 0) {
         steer /= (float) count;
@@ -237,7 +258,7 @@ class Boid
       PVector sum = PVector(0, 0);
       int count = 0;
       for (int i = 0; i < boidCount; i++) {
-        Boid other = boids[i];
+        const Boid& other = boids[i];
         if (!other.enabled)
           continue;
         float d = location.dist(other.location);
@@ -246,6 +267,10 @@ class Boid
           count++;
         }
       }
+      return alignmentSteer(sum, count);
+    }
+
+    PVector alignmentSteer(PVector sum, int count) const {
       if (count > 0) {
         sum /= (float) count;
         sum.normalize();
@@ -265,7 +290,7 @@ class Boid
       PVector sum = PVector(0, 0);   // Start with empty vector to accumulate all locations
       int count = 0;
       for (int i = 0; i < boidCount; i++) {
-        Boid other = boids[i];
+        const Boid& other = boids[i];
         if (!other.enabled)
           continue;
         float d = location.dist(other.location);
@@ -274,6 +299,10 @@ class Boid
           count++;
         }
       }
+      return cohesionSteer(sum, count);
+    }
+
+    PVector cohesionSteer(PVector sum, int count) const {
       if (count > 0) {
         sum /= count;
         return seek(sum);  // Steer towards the location
@@ -285,7 +314,7 @@ class Boid
 
     // A method that calculates and applies a steering force towards a target
     // STEER = DESIRED MINUS VELOCITY
-    PVector seek(PVector target) {
+    PVector seek(PVector target) const {
       PVector desired = target - location;  // A vector pointing from the location to the target
       // Normalize desired and scale to maximum speed
       desired.normalize();
@@ -373,3 +402,174 @@ class Boid
       return bounced;
     }
 };
+
+// BoidGrid
+//
+// Uniform-grid spatial index over a flock, rebuilt once per frame with Build().  The enabled boids' positions
+// and velocities are copied into separate packed arrays, sorted by grid cell with a counting sort, so that a
+// neighbor query only walks the few cells that overlap its radius and reads contiguous memory while doing so.
+// Boids that have strayed off the matrix are filed under the nearest edge cell.  The arrays are kept between
+// frames, so once the flock size has settled, rebuilding doesn't allocate.
+
+class BoidGrid
+{
+    float                                   _cellSize;
+    int                                     _columns;
+    int                                     _rows;
+
+    std::vector<size_t>                     _cellStart;     // Start of each cell's run in the packed arrays, plus an end sentinel
+    std::vector<size_t>                     _cursor;        // Scratch fill position per cell, used while building
+    std::vector<int>                        _cellOf;        // Scratch cell index per input boid, -1 if disabled
+
+    std::vector<float, psram_allocator<float>> _x, _y;       // Positions, in cell order
+    std::vector<float, psram_allocator<float>> _vx, _vy;     // Velocities, in cell order
+
+    int ColumnOf(float x) const
+    {
+        return std::clamp((int) floorf(x / _cellSize), 0, _columns - 1);
+    }
+
+    int RowOf(float y) const
+    {
+        return std::clamp((int) floorf(y / _cellSize), 0, _rows - 1);
+    }
+
+  public:
+
+    // The cell size should be at least the largest neighbor distance used by the flock, so that a query only
+    // ever has to look at the 3x3 block of cells around a boid
+
+    explicit BoidGrid(float cellSize = 8)
+      : _cellSize(cellSize),
+        _columns(std::max(1, (int) ceilf(MATRIX_WIDTH / cellSize))),
+        _rows(std::max(1, (int) ceilf(MATRIX_HEIGHT / cellSize))),
+        _cellStart(_columns * _rows + 1),
+        _cursor(_columns * _rows)
+    {
+    }
+
+    void Build(const Boid boids[], size_t boidCount)
+    {
+        std::fill(_cellStart.begin(), _cellStart.end(), 0);
+        _cellOf.resize(boidCount);
+
+        for (size_t i = 0; i < boidCount; i++)
+        {
+            if (!boids[i].enabled)
+            {
+                _cellOf[i] = -1;
+                continue;
+            }
+
+            int cell = RowOf(boids[i].location.y) * _columns + ColumnOf(boids[i].location.x);
+            _cellOf[i] = cell;
+            _cellStart[cell + 1]++;
+        }
+
+        for (size_t cell = 1; cell < _cellStart.size(); cell++)
+            _cellStart[cell] += _cellStart[cell - 1];
+
+        size_t total = _cellStart.back();
+        _x.resize(total);
+        _y.resize(total);
+        _vx.resize(total);
+        _vy.resize(total);
+
+        std::copy(_cellStart.begin(), _cellStart.end() - 1, _cursor.begin());
+
+        for (size_t i = 0; i < boidCount; i++)
+        {
+            if (_cellOf[i] < 0)
+                continue;
+
+            size_t slot = _cursor[_cellOf[i]]++;
+            _x[slot]  = boids[i].location.x;
+            _y[slot]  = boids[i].location.y;
+            _vx[slot] = boids[i].velocity.x;
+            _vy[slot] = boids[i].velocity.y;
+        }
+    }
+
+    size_t Count() const
+    {
+        return _x.size();
+    }
+
+    // Calls fn(location, velocity, distance) for every boid within 'radius' of 'location', skipping any at
+    // distance zero (which includes the boid doing the asking)
+
+    template <typename Fn>
+    void ForEachNeighbor(const PVector& location, float radius, Fn&& fn) const
+    {
+        const float radiusSq = radius * radius;
+
+        const int col0 = ColumnOf(location.x - radius), col1 = ColumnOf(location.x + radius);
+        const int row0 = RowOf(location.y - radius),    row1 = RowOf(location.y + radius);
+
+        for (int row = row0; row <= row1; row++)
+        {
+            // Cells in a row are adjacent, so the boids for the whole span are one contiguous run
+            size_t first = _cellStart[row * _columns + col0];
+            size_t last  = _cellStart[row * _columns + col1 + 1];
+
+            for (size_t i = first; i < last; i++)
+            {
+                float dx = _x[i] - location.x;
+                float dy = _y[i] - location.y;
+                float dSq = dx * dx + dy * dy;
+
+                if (dSq > 0 && dSq < radiusSq)
+                    fn(PVector(_x[i], _y[i]), PVector(_vx[i], _vy[i]), sqrtf(dSq));
+            }
+        }
+    }
+};
+
+inline void Boid::flock(const BoidGrid& grid)
+{
+    PVector sepSum(0, 0), aliSum(0, 0), cohSum(0, 0);
+    int sepCount = 0, neighborCount = 0;
+
+    grid.ForEachNeighbor(location, std::max(desiredseparation, neighbordist),
+        [&](const PVector& otherLocation, const PVector& otherVelocity, float d)
+        {
+            if (d < desiredseparation)
+            {
+                PVector diff = location - otherLocation;
+                diff.normalize();
+                diff /= d;
+                sepSum += diff;
+                sepCount++;
+            }
+            if (d < neighbordist)
+            {
+                aliSum += otherVelocity;
+                cohSum += otherLocation;
+                neighborCount++;
+            }
+        });
+
+    PVector sep = separationSteer(sepSum, sepCount);
+    PVector ali = alignmentSteer(aliSum, neighborCount);
+    PVector coh = cohesionSteer(cohSum, neighborCount);
+
+    // Same weights as the array version
+    sep *= 1.5;
+    applyForce(sep);
+    applyForce(ali);
+    applyForce(coh);
+}
+
+// FlockBoids
+//
+// Runs one flocking step for a whole flock: indexes it into the grid, then flocks and moves every enabled boid.
+// All boids steer based on where the flock was at the start of the step.
+
+inline void FlockBoids(Boid boids[], size_t boidCount, BoidGrid& grid)
+{
+    grid.Build(boids, boidCount);
+
+    for (size_t i = 0; i < boidCount; i++)
+        if (boids[i].enabled)
+            boids[i].run(grid);
+}
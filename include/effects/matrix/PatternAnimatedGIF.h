@@ -31,6 +31,10 @@
 //   that it calls to fetch the GIF data and to plot the pixels on the
 //   LED matrix.
 //
+//   While a GIF plays for the first time, what the decoder draws is
+//   recorded, and once it has gone through all frames the GIF is played
+//   back from that recording instead (see GIF_FRAME_CACHE).
+//
 // History:     Nov-21-2023         Davepl      Created
 //
 //---------------------------------------------------------------------------
@@ -45,7 +49,9 @@
 #include <ledmatrixgfx.h>
 #include <ArduinoJson.h>
 #include "systemcontainer.h"
+#include <list>
 #include <map>
+#include <unordered_map>
 #include "effects.h"
 #include "types.h"
 #include <GifDecoder.h>
@@ -113,6 +119,161 @@ static const std::map<GIFIdentifier, const GIFInfo, std::less<GIFIdentifier>, co
     { GIFIdentifier::Firelog,      GIFInfo(firelog_start,     firelog_end,     64, 32, 16 ) },      // 24 KB
 };
 
+// GIFFrameCache
+//
+// The frames of a GIF as the decoder drew them. A frame holds only the pixels the decoder wrote for it, which
+// for most GIFs is just what changed since the previous frame, as row spans of indices into a palette that all
+// frames share. Playing a frame back is then a matter of copying those spans to the matrix, once the previous
+// frame has been shown for as long as the GIF asked.
+
+struct GIFFrameCache
+{
+    static constexpr size_t kMaxColors = 256;
+    static constexpr size_t kMaxFrames = 512;
+
+    struct Span
+    {
+        uint16_t    x;
+        uint16_t    y;
+        uint16_t    length;
+    };
+
+    struct Frame
+    {
+        bool clearFirst = false;                                // The decoder cleared the screen before drawing
+        uint16_t delayMs = 0;                                   // How long the GIF shows this frame
+        std::vector<Span, psram_allocator<Span>> spans;
+        std::vector<uint8_t, psram_allocator<uint8_t>> indices; // Palette indices for all spans, one after the other
+    };
+
+    std::vector<CRGB, psram_allocator<CRGB>>   palette;
+    std::vector<Frame, psram_allocator<Frame>> frames;
+
+    // The memory the frames take up, near enough
+    size_t Bytes() const
+    {
+        size_t bytes = sizeof(*this) + palette.capacity() * sizeof(CRGB) + frames.capacity() * sizeof(Frame);
+
+        for (const auto& frame : frames)
+            bytes += frame.spans.capacity() * sizeof(Span) + frame.indices.capacity();
+
+        return bytes;
+    }
+};
+
+// GIFFrameRecorder
+//
+// Builds a GIFFrameCache from what the decoder draws. Pixels are collected until EndFrame() is called after
+// each decoded frame. If the GIF turns out to use more colors or frames than the cache can hold, the
+// recording is marked failed and the GIF just keeps being decoded.
+
+class GIFFrameRecorder
+{
+    uint16_t _width;
+    uint16_t _height;
+    std::unique_ptr<GIFFrameCache> _pCache;
+    std::vector<int16_t, psram_allocator<int16_t>> _pending;   // Palette index written to each pixel this frame, or -1
+    std::unordered_map<uint32_t, uint8_t> _colorIndices;
+    bool _pendingClear = false;
+    bool _failed       = false;
+
+  public:
+
+    GIFFrameRecorder(uint16_t width, uint16_t height)
+      : _width(width),
+        _height(height),
+        _pCache(make_unique_psram<GIFFrameCache>()),
+        _pending(width * height, -1)
+    {}
+
+    void RecordClear()
+    {
+        // Whatever was drawn before is wiped, so only the clear and what comes after it matter
+        std::fill(_pending.begin(), _pending.end(), -1);
+        _pendingClear = true;
+    }
+
+    void RecordPixel(int16_t x, int16_t y, CRGB color)
+    {
+        if (_failed || x < 0 || y < 0 || x >= _width || y >= _height)
+            return;
+
+        auto& palette = _pCache->palette;
+        uint32_t key = (color.r << 16) | (color.g << 8) | color.b;
+
+        auto entry = _colorIndices.find(key);
+        if (entry == _colorIndices.end())
+        {
+            if (palette.size() >= GIFFrameCache::kMaxColors)
+            {
+                _failed = true;
+                return;
+            }
+            entry = _colorIndices.emplace(key, palette.size()).first;
+            palette.push_back(color);
+        }
+
+        _pending[y * _width + x] = entry->second;
+    }
+
+    void EndFrame(uint16_t delayMs)
+    {
+        if (_failed)
+            return;
+
+        auto& frames = _pCache->frames;
+        if (frames.size() >= GIFFrameCache::kMaxFrames)
+        {
+            _failed = true;
+            return;
+        }
+
+        auto& frame = frames.emplace_back();
+        frame.clearFirst = _pendingClear;
+        frame.delayMs = delayMs;
+
+        for (uint16_t y = 0; y < _height; y++)
+        {
+            const int16_t * pRow = &_pending[y * _width];
+
+            for (uint16_t x = 0; x < _width; )
+            {
+                if (pRow[x] < 0)
+                {
+                    x++;
+                    continue;
+                }
+
+                uint16_t start = x;
+                while (x < _width && pRow[x] >= 0)
+                    frame.indices.push_back(pRow[x++]);
+
+                frame.spans.push_back({ start, y, (uint16_t)(x - start) });
+            }
+        }
+
+        frame.spans.shrink_to_fit();
+        frame.indices.shrink_to_fit();
+
+        std::fill(_pending.begin(), _pending.end(), -1);
+        _pendingClear = false;
+    }
+
+    bool Failed() const
+    {
+        return _failed;
+    }
+
+    // Hands over the recorded frames, if there are any and the recording didn't fail
+    std::unique_ptr<GIFFrameCache> TakeCache()
+    {
+        if (_failed || _pCache->frames.empty())
+            return nullptr;
+
+        return std::move(_pCache);
+    }
+};
+
 // The decoder needs us to track some state, but there's only one instance of the decoder, and
 // we can't pass it a pointer to our state because the callback doesn't allow you to pass any
 // context, and you can't use a lambda that captures the this pointer because that can't be
@@ -124,9 +285,69 @@ struct
     int             _offsetY   = 0;
     uint8_t         _fps       = 24;
     CRGB            _bkColor   = CRGB::Black;
+    GIFFrameRecorder * _pRecorder = nullptr;                    // Set while a GIF's frames are being recorded
 }
 g_gifDecoderState;
 
+// GIFFrameCaches
+//
+// Frames of the GIFs that have been decoded in full. They're kept here rather than in the effects, because those
+// are created anew every time they're played. Once the caches take up more than GIF_FRAME_CACHE_MAX_BYTES
+// together, the GIFs that were played least recently are dropped. Effects hold on to the cache they're playing
+// from, so dropping it here doesn't pull it from under them. Only used on the draw task.
+
+class GIFFrameCaches
+{
+    struct Entry
+    {
+        GIFIdentifier gifIndex;
+        std::shared_ptr<const GIFFrameCache> pCache;
+        size_t bytes;
+    };
+
+    std::list<Entry> _entries;                                  // Most recently played first
+    size_t _totalBytes = 0;
+
+  public:
+
+    // Returns the cache for a GIF, if there is one, and marks it as the most recently played
+    std::shared_ptr<const GIFFrameCache> Find(GIFIdentifier gifIndex)
+    {
+        auto entry = std::find_if(_entries.begin(), _entries.end(), [gifIndex](const Entry& e) { return e.gifIndex == gifIndex; });
+        if (entry == _entries.end())
+            return nullptr;
+
+        _entries.splice(_entries.begin(), _entries, entry);
+        return entry->pCache;
+    }
+
+    void Add(GIFIdentifier gifIndex, std::shared_ptr<const GIFFrameCache> pCache)
+    {
+        size_t bytes = pCache->Bytes();
+        if (bytes > GIF_FRAME_CACHE_MAX_BYTES)
+        {
+            debugW("Not caching GIF %d, its %zu bytes of frames won't fit", (int) gifIndex, bytes);
+            return;
+        }
+
+        _entries.remove_if([gifIndex](const Entry& e) { return e.gifIndex == gifIndex; });
+        _totalBytes = bytes;
+        for (const auto& entry : _entries)
+            _totalBytes += entry.bytes;
+
+        while (_totalBytes > GIF_FRAME_CACHE_MAX_BYTES)
+        {
+            debugI("Dropping cached frames of GIF %d", (int) _entries.back().gifIndex);
+            _totalBytes -= _entries.back().bytes;
+            _entries.pop_back();
+        }
+
+        _entries.push_front({ gifIndex, std::move(pCache), bytes });
+    }
+};
+
+inline GIFFrameCaches g_gifFrameCaches;
+
 // We dynamically allocate the GIF decoder because it's pretty big and we don't want to waste the base
 // ram on it.  This way it, and the GIFs it decodes, can live in PSRAM.
 
@@ -145,6 +366,13 @@ private:
     bool _preClear           = false;
     bool _gifReadyToDraw     = false;
 
+    std::shared_ptr<const GIFFrameCache> _pFrameCache;          // Set when we play back from the frame cache
+    size_t _frameIndex                 = 0;
+    std::unique_ptr<GIFFrameRecorder> _pRecorder;
+
+    unsigned long _lastFrameMs  = 0;                            // When the frame on screen was drawn
+    unsigned long _frameDelayMs = 0;                            // How long it's to stay there
+
     // GIF decoder callbacks.  These are static because the decoder doesn't allow you to pass any context, so they
     // have to be global.  We use the global g_gifDecoderState to track state.  The GifDecoder code calls back to
     // these callbacks to do the actual work of plotting them on the LED matrix.
@@ -155,6 +383,9 @@ private:
     {
         auto& g = *(g_ptrSystem->EffectManager().g());
         g.fillScreen(g.to16bit(g_gifDecoderState._bkColor));
+
+        if (g_gifDecoderState._pRecorder)
+            g_gifDecoderState._pRecorder->RecordClear();
     }
 
     // We decide when to update the screen, so this is a no-op
@@ -169,30 +400,99 @@ private:
     // This is called by the GIF decoder to draw a pixel.  We use the offset to center the GIF on the LED matrix.
 
     static void drawPixelCallback(int16_t x, int16_t y, uint8_t red, uint8_t green, uint8_t blue)
+    {
+        plotPixel(*(g_ptrSystem->EffectManager().g(0)), x, y, CRGB(red, green, blue));
+    }
+
+    // drawLineCallback
+    //
+    // This is called by the GIF decoder to draw a line of pixels.  The pixels are indices into a palette of
+    // 16-bit 5:6:5 colors, and pixels with the index 'skip' are transparent.
+
+    static void drawLineCallback(int16_t x, int16_t y, uint8_t *buf, int16_t w, uint16_t *palette, int16_t skip)
     {
         auto& g = *(g_ptrSystem->EffectManager().g(0));
+
+        for (int16_t i = 0; i < w; i++)
+        {
+            if (buf[i] == skip)
+                continue;
+
+            uint16_t color = palette[buf[i]];
+            uint8_t red   = (color >> 11) & 0x1F;
+            uint8_t green = (color >> 5)  & 0x3F;
+            uint8_t blue  = color & 0x1F;
+
+            plotPixel(g, x + i, y, CRGB((red << 3) | (red >> 2), (green << 2) | (green >> 4), (blue << 3) | (blue >> 2)));
+        }
+    }
+
+    // plotPixel
+    //
+    // Draws a pixel of the GIF, centered on the LED matrix, and records it if we're building a frame cache
+
+    static void plotPixel(GFXBase& g, int16_t x, int16_t y, CRGB color)
+    {
         if (false == g.isValidPixel(x  + g_gifDecoderState._offsetX, y + g_gifDecoderState._offsetY))
         {
             debugW("drawPixelCallbackInvalid pixel: %d, %d", x + g_gifDecoderState._offsetX, y + g_gifDecoderState._offsetY);
             return;
         }
-        g.leds[XY(x + g_gifDecoderState._offsetX, y + g_gifDecoderState._offsetY)] = CRGB(red, green, blue);
+        g.leds[XY(x + g_gifDecoderState._offsetX, y + g_gifDecoderState._offsetY)] = color;
+
+        if (g_gifDecoderState._pRecorder)
+            g_gifDecoderState._pRecorder->RecordPixel(x, y, color);
     }
 
-    // drawLineCallback
+    // drawCachedFrame
     //
-    // This is called by the GIF decoder to draw a line of pixels.
+    // Plays back a frame from the frame cache
 
-    static void drawLineCallback(int16_t x, int16_t y, uint8_t *buf, int16_t w, uint16_t *palette, int16_t skip)
+    void drawCachedFrame(const GIFFrameCache::Frame& frame)
     {
-        // I don't think this is ever called, but if it is, we may need to implement it.  For now, it seems they just
-        // call drawPixelCallback for each pixel in the image.
+        if (frame.clearFirst)
+            screenClearCallback();
 
-        throw new std::runtime_error("drawLineCallback not implemented for animated GIFs");
+        auto& g = *(g_ptrSystem->EffectManager().g(0));
+        const CRGB * pPalette = _pFrameCache->palette.data();
+        const uint8_t * pIndex = frame.indices.data();
+
+        // Rows are contiguous in the matrix's framebuffer, so each span is one straight run of pixels
+        for (const auto& span : frame.spans)
+        {
+            CRGB * pDest = &g.leds[XY(span.x + g_gifDecoderState._offsetX, span.y + g_gifDecoderState._offsetY)];
+            for (uint16_t i = 0; i < span.length; i++)
+                *pDest++ = pPalette[*pIndex++];
+        }
     }
 
-    // For slower animations that run at a lower framerate, we double the framerate by discarding every other frame,
-    // which allows us to draw the VU meter and so on at a useable rate even though the animation doesn't paint every time.
+    // StopRecording
+    //
+    // Stops recording frames, and if the recording went through the whole GIF, adds it to the frame cache
+
+    void StopRecording(bool complete)
+    {
+        // Another GIF effect may have started recording since, in which case we leave its recorder alone
+        if (g_gifDecoderState._pRecorder == _pRecorder.get())
+            g_gifDecoderState._pRecorder = nullptr;
+
+        if (complete && _pRecorder)
+        {
+            std::shared_ptr<const GIFFrameCache> pCache = _pRecorder->TakeCache();
+            if (pCache)
+            {
+                debugI("Cached %zu frames of GIF %d in %zu colors", pCache->frames.size(), (int) _gifIndex, pCache->palette.size());
+                _pFrameCache = pCache;
+                _frameIndex = 0;
+                g_gifFrameCaches.Add(_gifIndex, std::move(pCache));
+            }
+        }
+
+        _pRecorder.reset();
+    }
+
+    // For slower animations that run at a lower framerate, we double the framerate, which allows us to draw the VU meter
+    // and so on at a useable rate even though the animation doesn't paint every time (see FrameDue()).
 
     static bool FrameDoubling()
     {
@@ -204,6 +504,22 @@ private:
         return FrameDoubling() ? g_gifDecoderState._fps * 2 : g_gifDecoderState._fps;
     }
 
+    // FrameDue
+    //
+    // Returns true once the frame on screen has been shown for as long as the GIF asked. Frames without a delay
+    // are shown for as long as a frame lasts at the GIF's nominal frame rate.
+
+    bool FrameDue() const
+    {
+        return Millis() - _lastFrameMs >= _frameDelayMs;
+    }
+
+    void FrameDrawn(uint16_t delayMs)
+    {
+        _lastFrameMs  = Millis();
+        _frameDelayMs = delayMs ? delayMs : 1000 / std::max<uint8_t>(g_gifDecoderState._fps, 1);
+    }
+
 public:
 
     PatternAnimatedGIF(const String & friendlyName, GIFIdentifier gifIndex, bool preClear = false, CRGB bkColor = CRGB::Black) :
@@ -222,6 +538,11 @@ public:
     {
     }
 
+    ~PatternAnimatedGIF()
+    {
+        StopRecording(false);
+    }
+
     bool SerializeToJSON(JsonObject& jsonObject) override
     {
         auto jsonDoc = CreateJsonDocument();
@@ -264,23 +585,42 @@ public:
         g_ptrGIFDecoder->setDrawPixelCallback( drawPixelCallback );
         g_ptrGIFDecoder->setDrawLineCallback( drawLineCallback );
 
+        // If we've decoded this GIF in full before, we play it back from the frame cache
+
+        StopRecording(false);
+
+        _lastFrameMs = Millis();
+        _frameDelayMs = 0;
+
+        _pFrameCache = g_gifFrameCaches.Find(_gifIndex);
+        if (_pFrameCache)
+        {
+            _frameIndex = 0;
+            return;
+        }
+
         _gifReadyToDraw = (ERROR_NONE == g_ptrGIFDecoder->startDecoding((uint8_t *) gif->second.contents, gif->second.length));
         if (!_gifReadyToDraw)
+        {
             debugW("Failed to start decoding GIF");
+            return;
+        }
+
+        // Record the frames as the decoder draws them, so next time around we can skip the decoding
+
+        #if GIF_FRAME_CACHE
+            _pRecorder = std::make_unique<GIFFrameRecorder>(gif->second._width, gif->second._height);
+            g_gifDecoderState._pRecorder = _pRecorder.get();
+        #endif
     }
 
     void Draw() override
     {
-        // If we're running a low FPS animation, we discard alternate frames and draw every other one, which allows
-        // the VU meter to paint on every frame and remain responsive.
+        // The frame on screen stays until its delay is up. We're usually called more often than that (twice as often
+        // for low FPS animations), which allows the VU meter to paint on every frame and remain responsive.
 
-        static bool discardFrame = false;
-        if (FrameDoubling())
-        {
-            discardFrame = !discardFrame;
-            if (discardFrame)
-                return;
-        }
+        if (!FrameDue())
+            return;
 
         // GIFs that use transparency will leave the previous frame in place, so we need
         // to clear the screen before we draw the next frame.  We can skip this if the
@@ -289,9 +629,35 @@ public:
         if (_preClear)
             g()->Clear(_bkColor);
 
-        if (_gifReadyToDraw)
-            g_ptrGIFDecoder->decodeFrame(false);
+        if (_pFrameCache)
+        {
+            const auto& frame = _pFrameCache->frames[_frameIndex];
+            drawCachedFrame(frame);
+            FrameDrawn(frame.delayMs);
 
+            _frameIndex = (_frameIndex + 1) % _pFrameCache->frames.size();
+            return;
+        }
+
+        if (!_gifReadyToDraw)
+            return;
+
+        int result = g_ptrGIFDecoder->decodeFrame(false);
+        uint16_t delayMs = result == ERROR_NONE ? g_ptrGIFDecoder->getFrameDelay_ms() : 0;
+
+        FrameDrawn(delayMs);
+
+        // The decoder tells us it's done parsing when it's gone through all frames and starts over
+
+        if (_pRecorder)
+        {
+            if (result < 0 || _pRecorder->Failed())
+                StopRecording(false);
+            else if (result == ERROR_NONE)
+                _pRecorder->EndFrame(delayMs);
+            else if (result == ERROR_DONE_PARSING)
+                StopRecording(true);
+        }
     }
 };
 
@@ -0,0 +1,178 @@
+//+--------------------------------------------------------------------------
+//
+// File:        PatternFlock.h
+//
+// NightDriverStrip - (c) 2018 Plummer's Software LLC.  All Rights Reserved.
+//
+// This file is part of the NightDriver software project.
+//
+//    NightDriver is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    NightDriver is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with Nightdriver.  It is normally found in copying.txt
+//    If not, see <https://www.gnu.org/licenses/>.
+//
+//
+// Description:
+//
+//   Effect code ported from Aurora to Mesmerizer's draw routines
+//
+//---------------------------------------------------------------------------
+
+/*
+ * Aurora: https://github.com/pixelmatix/aurora
+ * Copyright (c) 2014 Jason Coon
+ *
+ * Portions of this code are adapted from "Flocking" in "The Nature of Code" by Daniel Shiffman: http://natureofcode.com/
+ * Copyright (c) 2014 Daniel Shiffman
+ * http://www.shiffman.net
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "Vector.h"
+#include "Boid.h"
+
+// PatternFlock
+//
+// A flock of boids wandering around the matrix, steering by separation, alignment and cohesion, with a gust of
+// wind every now and then.  Every 30 seconds a predator joins or leaves, and the flock scatters away from it.
+//
+// Aurora ran ten boids, comparing each against every other one.  This flock is several times larger, so it is
+// indexed into a BoidGrid once per frame and each boid only looks at the boids in the cells around it.
+
+class PatternFlock : public LEDStripEffect
+{
+private:
+    static constexpr size_t boidCount = 48;
+
+    Boid *   _boids = nullptr;                  // boidCount of them, from the effect's arena
+    BoidGrid _grid { 8 };                       // Cell size matches the boids' neighbor distance
+    Boid     _predator;
+    bool     _predatorPresent = true;
+    PVector  _wind;
+    uint8_t  _hue = 0;
+
+    unsigned long _lastHueMs      = 0;
+    unsigned long _lastPredatorMs = 0;
+
+public:
+    PatternFlock() : LEDStripEffect(EFFECT_MATRIX_FLOCK, "Flock")
+    {
+    }
+
+    PatternFlock(const JsonObjectConst& jsonObject) : LEDStripEffect(jsonObject)
+    {
+    }
+
+    bool Prepare() override
+    {
+        if (_boids)
+            return true;
+
+        _boids = Arena().Allocate<Boid>(boidCount);
+        if (!_boids)
+        {
+            debugE("Could not allocate %zu boids", boidCount);
+            return false;
+        }
+
+        return true;
+    }
+
+    bool Init(std::vector<std::shared_ptr<GFXBase>>& gfx) override
+    {
+        return LEDStripEffect::Init(gfx) && Prepare();
+    }
+
+    void Start() override
+    {
+        for (size_t i = 0; i < boidCount; i++)
+        {
+            _boids[i] = Boid(random(MATRIX_WIDTH), random(MATRIX_HEIGHT));
+            _boids[i].maxspeed = 0.380;
+            _boids[i].maxforce = 0.015;
+        }
+
+        _predatorPresent = random(0, 2) >= 1;
+
+        _predator = Boid(MATRIX_WIDTH - 1, MATRIX_HEIGHT - 1);
+        _predator.maxspeed = 0.385;
+        _predator.maxforce = 0.020;
+        _predator.neighbordist = 16.0;
+        _predator.desiredseparation = 0.0;
+
+        _lastHueMs = _lastPredatorMs = Millis();
+    }
+
+    void Draw() override
+    {
+        auto graphics = g();
+
+        graphics->DimAll(230);
+
+        bool applyWind = random(0, 255) > 250;
+        if (applyWind)
+        {
+            _wind.x = Boid::randomf() * .015;
+            _wind.y = Boid::randomf() * .015;
+
+            // As in Aurora, the gust only catches one boid
+            _boids[random(boidCount)].applyForce(_wind);
+        }
+
+        // Flee from the predator
+        if (_predatorPresent)
+            for (size_t i = 0; i < boidCount; i++)
+                _boids[i].repelForce(_predator.location, 10);
+
+        FlockBoids(_boids, boidCount, _grid);
+
+        CRGB color = graphics->ColorFromCurrentPalette(_hue);
+
+        for (size_t i = 0; i < boidCount; i++)
+        {
+            _boids[i].wrapAroundBorders();
+            graphics->drawPixel(_boids[i].location.x, _boids[i].location.y, color);
+        }
+
+        // The predator chases the flock using the grid that was just built for it
+        if (_predatorPresent)
+        {
+            _predator.run(_grid);
+            _predator.wrapAroundBorders();
+            graphics->drawPixel(_predator.location.x, _predator.location.y, graphics->ColorFromCurrentPalette(_hue + 128));
+        }
+
+        if (IsIntervalDue(_lastHueMs, 200))
+            _hue++;
+
+        if (IsIntervalDue(_lastPredatorMs, 30000))
+            _predatorPresent = !_predatorPresent;
+    }
+};
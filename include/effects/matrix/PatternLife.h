@@ -64,11 +64,6 @@
 
 #include <bitset>
 
-extern "C"
-{
-    #include "uzlib/src/uzlib.h"
-}
-
 // Introduction:
 // -------------
 // This file contains the implementation for a life simulation game, inspired by Conway's Game of Life,
@@ -114,13 +109,155 @@ extern "C"
 //    visualization on the LED matrix.
 //
 
-class Cell
+// LifeGrid
+//
+// Bit-packed, toroidal Life world.  Each row is a run of 32-bit words holding one bit per cell, and a generation
+// is stepped a word at a time: the eight neighbor bitmaps for a word are summed with a small network of bitwise
+// adders, so 32 cells are decided with a couple of dozen logic operations instead of 32 rounds of eight lookups.
+// A hash of the new generation is folded in as its words are produced, so cycle detection doesn't need its own
+// pass over the world.  The grid doesn't draw anything, so it can also be stepped as a background simulation.
+
+class LifeGrid
 {
-public:
-  uint8_t alive : 1;
-  uint8_t prev  : 1;
-  uint8_t hue;
-  uint8_t brightness;
+    const int       _width;
+    const int       _height;
+    const int       _wordsPerRow;
+    const int       _lastBit;                   // Bit position of the last cell within the last word of a row
+    const uint32_t  _lastWordMask;              // Valid bits in the last word of a row; the rest are kept at zero
+
+    std::unique_ptr<uint32_t []> _current;
+    std::unique_ptr<uint32_t []> _previous;
+    uint32_t        _hash;
+
+    static constexpr uint32_t kHashSeed  = 2166136261u;     // FNV-1a offset basis and prime, applied per word
+    static constexpr uint32_t kHashPrime = 16777619u;
+
+    uint32_t * Row(uint32_t * world, int y) const
+    {
+        return world + y * _wordsPerRow;
+    }
+
+    // Each cell's west (x-1) and east (x+1) neighbors, shifted into the cell's own bit position
+
+    uint32_t West(const uint32_t * row, int w) const
+    {
+        uint32_t carry = w > 0 ? row[w - 1] >> 31 : (row[_wordsPerRow - 1] >> _lastBit) & 1;
+        return (row[w] << 1) | carry;
+    }
+
+    uint32_t East(const uint32_t * row, int w) const
+    {
+        if (w < _wordsPerRow - 1)
+            return (row[w] >> 1) | (row[w + 1] << 31);
+        return (row[w] >> 1) | ((row[0] & 1) << _lastBit);
+    }
+
+    static void FullAdd(uint32_t a, uint32_t b, uint32_t c, uint32_t & sum, uint32_t & carry)
+    {
+        uint32_t t = a ^ b;
+        sum   = t ^ c;
+        carry = (a & b) | (t & c);
+    }
+
+  public:
+
+    LifeGrid(int width, int height)
+      : _width(width),
+        _height(height),
+        _wordsPerRow((width + 31) / 32),
+        _lastBit((width - 1) % 32),
+        _lastWordMask(_lastBit == 31 ? 0xFFFFFFFF : (1u << (_lastBit + 1)) - 1),
+        _current(std::make_unique<uint32_t []>(_wordsPerRow * height)),
+        _previous(std::make_unique<uint32_t []>(_wordsPerRow * height))
+    {
+        Clear();
+    }
+
+    void Clear()
+    {
+        std::fill_n(_current.get(), _wordsPerRow * _height, 0);
+        std::fill_n(_previous.get(), _wordsPerRow * _height, 0);
+        RecomputeHash();
+    }
+
+    bool IsAlive(int x, int y) const
+    {
+        return (_current[y * _wordsPerRow + x / 32] >> (x % 32)) & 1;
+    }
+
+    // State of the cell in the generation before the last Step()
+    bool WasAlive(int x, int y) const
+    {
+        return (_previous[y * _wordsPerRow + x / 32] >> (x % 32)) & 1;
+    }
+
+    void Set(int x, int y, bool alive)
+    {
+        uint32_t & word = _current[y * _wordsPerRow + x / 32];
+        uint32_t bit = 1u << (x % 32);
+        word = alive ? (word | bit) : (word & ~bit);
+    }
+
+    // Hash of the current generation.  Call RecomputeHash() after changing cells with Set(); Step() keeps it
+    // up to date on its own.
+
+    uint32_t Hash() const
+    {
+        return _hash;
+    }
+
+    void RecomputeHash()
+    {
+        _hash = kHashSeed;
+        for (int i = 0; i < _wordsPerRow * _height; i++)
+            _hash = (_hash ^ _current[i]) * kHashPrime;
+    }
+
+    // Advances the world one generation.  The old generation stays available through WasAlive().
+
+    void Step()
+    {
+        uint32_t hash = kHashSeed;
+
+        for (int y = 0; y < _height; y++)
+        {
+            const uint32_t * above = Row(_current.get(), (y + _height - 1) % _height);
+            const uint32_t * row   = Row(_current.get(), y);
+            const uint32_t * below = Row(_current.get(), (y + 1) % _height);
+            uint32_t * out         = Row(_previous.get(), y);
+
+            for (int w = 0; w < _wordsPerRow; w++)
+            {
+                // Sum the eight neighbor bitmaps bit-serially: the sums of three groups are added into a ones
+                // bit, the carries into a twos bit, and anything that carries past that means four or more
+
+                uint32_t s1, c1, s2, c2, s3, c3, ones, c4, t, c5, twos, c6;
+
+                FullAdd(West(above, w), above[w], East(above, w), s1, c1);
+                FullAdd(West(below, w), below[w], East(below, w), s2, c2);
+                s3 = West(row, w) ^ East(row, w);
+                c3 = West(row, w) & East(row, w);
+
+                FullAdd(s1, s2, s3, ones, c4);
+                FullAdd(c1, c2, c3, t, c5);
+                twos = t ^ c4;
+                c6   = t & c4;
+
+                uint32_t fours = c5 | c6;
+
+                // Alive next generation with exactly three neighbors, or with two if already alive
+                uint32_t next = twos & ~fours & (ones | row[w]);
+                if (w == _wordsPerRow - 1)
+                    next &= _lastWordMask;
+
+                out[w] = next;
+                hash = (hash ^ next) * kHashPrime;
+            }
+        }
+
+        std::swap(_current, _previous);
+        _hash = hash;
+    }
 };
 
 // We check for loops by keeping a number of hashes of previous frames.  A walker that goes up and across
@@ -131,24 +268,33 @@ constexpr auto CRC_LENGTH = (std::max(MATRIX_HEIGHT, MATRIX_WIDTH) * 4 + 1);
 class PatternLife : public LEDStripEffect
 {
 private:
-    std::unique_ptr<Cell [][MATRIX_HEIGHT]> world;
-    std::unique_ptr<uint32_t []> checksums;
+    std::unique_ptr<LifeGrid> world;
+    std::unique_ptr<uint8_t []> hue;                // Per-cell color and brightness, used only for drawing
+    std::unique_ptr<uint8_t []> brightness;
+    std::unique_ptr<uint32_t []> checksums;         // Ring of the hashes of recent generations
     int iChecksum = 0;
+    int cChecksums = 0;
     uint32_t bStuckInLoop = 0;
     unsigned int density = 50;
     int cGeneration = 0;
     unsigned long seed;
 
+    static int CellIndex(int x, int y)
+    {
+        return y * MATRIX_WIDTH + x;
+    }
 
     bool Init(std::vector<std::shared_ptr<GFXBase>>& gfx) override
     {
         LEDStripEffect::Init(gfx);
 
-        // Note: placing the world in PSRAM may slow this effect down, but it's currently running
-        //       fast enough (30+ fps) that we can afford to use it
+        // The bit-packed world itself is tiny, so it stays in internal RAM; the per-cell drawing state is
+        // only touched once per cell per frame and can live in PSRAM
 
-        world.reset(psram_allocator<Cell [MATRIX_HEIGHT]>().allocate(MATRIX_WIDTH)) ;
-        checksums.reset(psram_allocator<uint32_t>().allocate(CRC_LENGTH));
+        world = std::make_unique<LifeGrid>(MATRIX_WIDTH, MATRIX_HEIGHT);
+        hue = make_unique_psram_array<uint8_t>(MATRIX_WIDTH * MATRIX_HEIGHT);
+        brightness = make_unique_psram_array<uint8_t>(MATRIX_WIDTH * MATRIX_HEIGHT);
+        checksums = make_unique_psram_array<uint32_t>(CRC_LENGTH);
 
         return true;
     }
@@ -205,32 +351,16 @@ private:
         srand(seed);
         for (int i = 0; i < MATRIX_WIDTH; i++) {
             for (int j = 0; j < MATRIX_HEIGHT; j++) {
-                if ((rand() % 100) < density) {
-                    world[i][j].alive = 1;
-                    world[i][j].brightness = 128;
-                }
-                else {
-                    world[i][j].alive = 0;
-                    world[i][j].brightness = 0;
-                }
-                world[i][j].prev = world[i][j].alive;
-                world[i][j].hue = 0;
+                bool alive = (rand() % 100) < density;
+                world->Set(i, j, alive);
+                brightness[CellIndex(i, j)] = alive ? 128 : 0;
+                hue[CellIndex(i, j)] = 0;
             }
         }
+        world->RecomputeHash();
 
-        for (int i = 0; i < CRC_LENGTH; i++)
-            checksums[i] = 0xFFFFFFF;
-    }
-
-    int neighbours(int x, int y) {
-        return (world[(x + 1) % MATRIX_WIDTH][y].prev) +
-            (world[x][(y + 1) % MATRIX_HEIGHT].prev) +
-            (world[(x + MATRIX_WIDTH - 1) % MATRIX_WIDTH][y].prev) +
-            (world[x][(y + MATRIX_HEIGHT - 1) % MATRIX_HEIGHT].prev) +
-            (world[(x + 1) % MATRIX_WIDTH][(y + 1) % MATRIX_HEIGHT].prev) +
-            (world[(x + MATRIX_WIDTH - 1) % MATRIX_WIDTH][(y + 1) % MATRIX_HEIGHT].prev) +
-            (world[(x + MATRIX_WIDTH - 1) % MATRIX_WIDTH][(y + MATRIX_HEIGHT - 1) % MATRIX_HEIGHT].prev) +
-            (world[(x + 1) % MATRIX_WIDTH][(y + MATRIX_HEIGHT - 1) % MATRIX_HEIGHT].prev);
+        iChecksum = 0;
+        cChecksums = 0;
     }
 
 public:
@@ -246,8 +376,6 @@ public:
     void Reset()
     {
         randomFillWorld();
-        for (int i = 0; i < CRC_LENGTH; i++)
-            checksums[i] = 0xFFFFFFF;
         cGeneration = 0;
         bStuckInLoop = 0;
     }
@@ -261,31 +389,19 @@ public:
 
         for (int i = 0; i < MATRIX_WIDTH; i++) {
             for (int j = 0; j < MATRIX_HEIGHT; j++) {
-                if (world[i][j].brightness > 0)
-                    g()->leds[XY(i, j)] += g()->ColorFromCurrentPalette(world[i][j].hue * 4, world[i][j].brightness);
+                auto cell = CellIndex(i, j);
+                if (brightness[cell] > 0)
+                    g()->leds[XY(i, j)] += g()->ColorFromCurrentPalette(hue[cell] * 4, brightness[cell]);
                 else
                     g()->leds[XY(i, j)] = CRGB::Black;
             }
         }
 
-        // We maintain a scrolling window of the last N crcs and if the current crc makes it all
-        // the way down to the bottom half we assume we're stuck in a loop and restart.
-        // We have to first extract the alive bits alone because we don't want the hue and brightness
-        // data to mess with the CRC.
-
-        bool alive[MATRIX_WIDTH][MATRIX_HEIGHT];
-        for (int i = 0; i < MATRIX_WIDTH; i++)
-            for (int j = 0; j < MATRIX_HEIGHT; j++)
-                alive[i][j] = world[i][j].alive;
-
-        auto crc = uzlib_crc32(alive, sizeof(alive), 0xffffffff);
-        for (int i = 0; i < CRC_LENGTH - 1; i++)
-            checksums[i] = checksums[i+1];
-        checksums[CRC_LENGTH - 1] = crc;
-
+        // We keep a rolling window of the hashes of the last N generations, and if the current generation's
+        // hash is already in there we assume we're stuck in a loop and restart.  The hash only covers which
+        // cells are alive, so hue and brightness don't affect it.
 
-        // Look for any occurrences of the current CRC in the first half of the window, which would mean
-        // a loop has occurred.  If
+        auto crc = world->Hash();
 
         if (bStuckInLoop)
         {
@@ -300,59 +416,58 @@ public:
             }
             g()->DimAll(255 - 255*elapsed/resetTime);
 
-            for (int x = 0; x < MATRIX_WIDTH; x++)
-                for (int y = 0; y < MATRIX_HEIGHT; y++)
-                        world[x][y].brightness *= 0.9;
+            for (int cell = 0; cell < MATRIX_WIDTH * MATRIX_HEIGHT; cell++)
+                brightness[cell] *= 0.9;
             if (elapsed > resetTime)
                 Reset();
         }
         else
         {
-            for (int i = CRC_LENGTH - 2; i >= 0; i--)
+            for (int i = 0; i < cChecksums; i++)
             {
                 if (checksums[i] == crc)
                 {
                     bStuckInLoop = millis();
                     debugV("Seed: %10lu, Generations: %5d, %s", seed, cGeneration, cGeneration > 3000 ? "Y" : "N");
-                }
-                if (checksums[i] == 0xFFFFFFF)
                     break;
+                }
             }
         }
 
+        // Add the current hash to the window, replacing the oldest one once it's full
+
+        checksums[iChecksum] = crc;
+        iChecksum = (iChecksum + 1) % CRC_LENGTH;
+        if (cChecksums < CRC_LENGTH)
+            cChecksums++;
+
         // Birth and death cycle
+
+        world->Step();
+
         for (int x = 0; x < MATRIX_WIDTH; x++) {
             for (int y = 0; y < MATRIX_HEIGHT; y++) {
+                auto cell = CellIndex(x, y);
+                bool wasAlive = world->WasAlive(x, y);
+
                 // Default is for cell to stay the same
-                if (world[x][y].brightness > 0 && world[x][y].prev == 0)
-                  world[x][y].brightness *= 0.75;
+                if (brightness[cell] > 0 && !wasAlive)
+                    brightness[cell] *= 0.75;
+
+                if (world->IsAlive(x, y) == wasAlive)
+                    continue;
 
-                int count = neighbours(x, y);
-                if (count == 3 && world[x][y].prev == 0) {
+                if (!wasAlive) {
                     // A new cell is born
-                    world[x][y].alive = 1;
-                    world[x][y].hue += 1;
-                    world[x][y].brightness = 255;
-                } else if ((count < 2 || count > 3) && world[x][y].prev == 1) {
+                    hue[cell] += 1;
+                    brightness[cell] = 255;
+                } else {
                     // Cell dies
-                    world[x][y].alive = 0;
-                    world[x][y].brightness = 0;
+                    brightness[cell] = 0;
                 }
             }
         }
 
-        // Copy next generation into place
-
-        int cCount = 0;
-
-        for (int x = 0; x < MATRIX_WIDTH; x++) {
-            for (int y = 0; y < MATRIX_HEIGHT; y++) {
-                if (world[x][y].prev != world[x][y].alive)
-                    cCount++;
-                world[x][y].prev = world[x][y].alive;
-            }
-        }
-
         cGeneration++;
     }
 };
@@ -175,7 +175,7 @@ public:
                 uint8_t bri = color;
 
                 // assign a color depending on the actual palette
-                CRGB pixel = ColorFromPalette(g()->GetCurrentPalette(), colorrepeat * (color + colorshift), bri);
+                CRGB pixel = g()->ColorFromCurrentPalette(colorrepeat * (color + colorshift), bri);
 
                 g()->leds[XY(i, j)] = pixel;
             }
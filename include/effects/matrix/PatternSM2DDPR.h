@@ -53,7 +53,7 @@ class PatternSM2DDPR : public LEDStripEffect
 
     void Draw() override
     {
-        effTimer = sin8(millis() / 6000) / 10;
+        effTimer = sin8(Millis() / 6000) / 10;
 
         EVERY_N_MILLISECONDS(1)
         {
@@ -45,11 +45,18 @@ class PatternSMFire2021 : public LEDStripEffect
     void Draw() override
     {
         ff_x += step; // static uint32_t t += speed;
-        for (unsigned x = 0; x < MATRIX_WIDTH; x++)
+
+        // Walk the matrix a row at a time; the noise y coordinate and the cooling towards the top of the flame
+        // only depend on the row, so they're worked out once per row rather than once per pixel
+
+        for (unsigned y = 0; y < MATRIX_HEIGHT; y++)
         {
-            for (unsigned y = 0; y < MATRIX_HEIGHT; y++)
+            const uint16_t noiseY = (y * deltaValue) - ff_x;
+            const int16_t rowCooling = y * (255 / MATRIX_HEIGHT);
+
+            for (unsigned x = 0; x < MATRIX_WIDTH; x++)
             {
-                int16_t Bri = inoise8(x * deltaValue, (y * deltaValue) - ff_x, ff_z) - (y * (255 / MATRIX_HEIGHT));
+                int16_t Bri = inoise8(x * deltaValue, noiseY, ff_z) - rowCooling;
                 uint8_t Col = Bri; // inoise8(x * deltaValue, (y * deltaValue) - ff_x, ff_z) - (y * (255 / MATRIX_HEIGHT));
                 if (Bri < 0)
                     Bri = 0;
@@ -41,7 +41,7 @@ class PatternSMGamma : public LEDStripEffect
             222, 225, 227, 229, 232, 234, 236, 239, 241, 244, 246, 249, 251, 253, 254, 255
         };
 
-        int a = millis() / 8;
+        int a = Millis() / 8;
         for (uint x = 0; x < MATRIX_WIDTH; x++)
         {
             for (uint y = 0; y < MATRIX_HEIGHT; y++)
@@ -46,14 +46,15 @@ class PatternSMHypnosis : public LEDStripEffect
     }
 
     uint16_t t = 0;
+    const PaletteTable _stripeTable { RainbowStripeColors_p };
 
     void Draw() override
     {
         t += 4;
+        const PaletteTable &table = g()->IsPalettePaused() ? g()->GetCurrentPaletteTable() : _stripeTable;
+
         for (uint x = 0; x < MATRIX_WIDTH; x++)
             for (uint y = 0; y < MATRIX_HEIGHT; y++)
-                g()->leds[XY(x, y)] = ColorFromPalette(g()->IsPalettePaused()
-                                      ? g()->GetCurrentPalette()
-                                      : RainbowStripeColors_p, t / 2 + rMap[x][y].radius + rMap[x][y].angle, sin8(rMap[x][y].angle + (rMap[x][y].radius * 2) - t));
+                g()->leds[XY(x, y)] = table.Color(t / 2 + rMap[x][y].radius + rMap[x][y].angle, sin8(rMap[x][y].angle + (rMap[x][y].radius * 2) - t));
     }
 };
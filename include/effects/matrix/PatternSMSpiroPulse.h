@@ -78,7 +78,7 @@ class PatternSMSpiroPulse : public LEDStripEffect
         // fadeToBlackBy(leds, NUM_LEDS, 8);
         fadeAllChannelsToBlackBy(8);
 
-        float t = (float)millis() / 500.0f;
+        float t = (float)Millis() / 500.0f;
         float CalcRad = (sin(t / 2) + 1);
         if (CalcRad <= 0.001)
         {
@@ -127,9 +127,7 @@ class AnimatedText
     void Draw(GFXBase *g)
     {
         g->setFont(pfont);
-        g->setTextColor(g->to16bit(color));
-        g->setCursor(currentX, currentY);
-        g->print(text);
+        g->DrawCachedText(currentX, currentY, text, color);
     }
 };
 
@@ -205,22 +203,47 @@ private:
 
     using StockDataCallback = function<void(const StockData&)>;
 
-    HTTPClient http;
+    // QuoteFilter
+    //
+    // The fields of a quote that we actually use; everything else the server sends is skipped while parsing
+
+    static JsonDocument QuoteFilter()
+    {
+        JsonDocument filter;
+
+        for (auto field : { "symbol", "timestamp", "previous_close", "open", "high", "low", "close", "volume" })
+            filter[field] = true;
+
+        filter["points"][0]["dt"]  = true;
+        filter["points"][0]["val"] = true;
+
+        return filter;
+    }
+
+    // GetQuote
+    //
+    // Queues the request for a quote with the HTTP fetcher; the callback is invoked from one of its worker tasks
+    // once the quote is in. Quotes are cached for half the fetch interval, so an effect that is started again
+    // shortly after it last ran can show them right away.
 
     void GetQuote(const String &symbol, StockDataCallback callback = nullptr)
     {
-        http.begin("http://" + stockServer + "/?ticker=" + symbol);
+        static const JsonDocument filter = QuoteFilter();
+        const auto cacheTime = duration_cast<milliseconds>(STOCKS_FETCH_INTERVAL_SECONDS / 2).count();
 
-        int httpCode = http.GET();
-        if (httpCode == HTTP_CODE_OK)
+        g_ptrSystem->HTTPFetcher().FetchJSON("http://" + stockServer + "/?ticker=" + symbol, filter, [callback](const HTTPResponse& response, JsonDocument& doc)
+        {
+            ParseQuote(response, doc, callback);
+        }, this, cacheTime);
+    }
+
+    static void ParseQuote(const HTTPResponse& response, JsonDocument& doc, StockDataCallback callback)
+    {
+        if (response.statusCode == HTTP_CODE_OK)
         {
             debugI("HTTP GET OK");
-            String payload = http.getString(); // Get the response payload
-            auto doc = CreateJsonDocument();
-            DeserializationError error = deserializeJson(doc, payload);
-            debugV("JSON: %s", payload.c_str());
 
-            if (!error)
+            if (!response.jsonError)
             {
                 StockData stockData;
                 stockData.symbol        = doc["symbol"].as<String>();
@@ -244,19 +267,17 @@ private:
             }
             else
             {
-                debugE("Failed to parse JSON: %s\n", error.c_str());
+                debugE("Failed to parse JSON: %s\n", response.jsonError.c_str());
                 if (callback)
                     callback(StockData()); // Parsing error
             }
         }
         else
         {
-            debugE("[HTTP] GET failed, error: %s\n", http.errorToString(httpCode).c_str());
+            debugE("[HTTP] GET failed, error: %s\n", response.ErrorString().c_str());
             if (callback)
                 callback(StockData()); // HTTP request error
         }
-
-        http.end(); // Close the connection properly
     }
 
     // GetAllQuotes
@@ -366,6 +387,7 @@ public:
     ~PatternStocks()
     {
         g_ptrSystem->NetworkReader().CancelReader(readerIndex);
+        g_ptrSystem->HTTPFetcher().CancelFetches(this);
     }
 
     bool SerializeToJSON(JsonObject& jsonObject) override
@@ -387,8 +409,9 @@ public:
         if (!LEDStripEffect::Init(gfx))
             return false;
 
-        // Register a Network Reader task with no interval.  Will manually flag in Draw()
-        readerIndex = g_ptrSystem->NetworkReader().RegisterReader([this] { FetchQuotes(); });
+        // Register a Network Reader task with no interval.  Will manually flag in Draw(). Like the weather reader,
+        //   it only queues requests with the HTTP fetcher, for data that's on screen.
+        readerIndex = g_ptrSystem->NetworkReader().RegisterReader([this] { FetchQuotes(); }, 0, false, { "Stocks", ReaderPriority::High, 100 });
 
         // Fire off the stock data reader for an initial download of stock data
         lastUpdate = system_clock::now();
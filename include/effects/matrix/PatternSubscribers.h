@@ -208,7 +208,8 @@ class PatternSubscribers : public LEDStripEffect
         if (!LEDStripEffect::Init(gfx))
             return false;
 
-        readerIndex = g_ptrSystem->NetworkReader().RegisterReader([this] { SubscriberReader(); }, SUB_READER_INTERVAL, true);
+        // The reader does its own (blocking) HTTP request, so it gets more time than the default budget
+        readerIndex = g_ptrSystem->NetworkReader().RegisterReader([this] { SubscriberReader(); }, SUB_READER_INTERVAL, true, { "Subscribers", ReaderPriority::Low, 5000 });
 
         return true;
     }
@@ -238,8 +239,9 @@ class PatternSubscribers : public LEDStripEffect
         while (z/=10)
           x-= CHAR_WIDTH / 2;
 
-        String result = str_sprintf("%ld", subscribers);
-        const char * pszText = result.c_str();
+        // Format into a local buffer rather than a String so drawing doesn't hit the heap every frame
+        char pszText[24];
+        snprintf(pszText, sizeof(pszText), "%ld", subscribers);
 
         LEDMatrixGFX::backgroundLayer.setFont(gohufont11b);
         LEDMatrixGFX::backgroundLayer.drawString(x-1, y,   rgb24(0,0,0),          pszText);
@@ -102,7 +102,7 @@ public:
         uint8_t nj = (MATRIX_HEIGHT - 1) - j;
 
         // The color of each point shifts over time, each at a different speed.
-        uint16_t ms = millis();
+        uint16_t ms = Millis();
 
         drawAt(i, j, graphics->ColorFromCurrentPalette(ms / 11));
         drawAt(i, j, graphics->ColorFromCurrentPalette(ms / 11));
@@ -46,6 +46,7 @@
 #include <chrono>
 #include <thread>
 #include <map>
+#include <mutex>
 #include "TJpg_Decoder.h"
 #include "effects.h"
 #include "types.h"
@@ -56,6 +57,10 @@ using namespace std::chrono_literals;
 #define WEATHER_INTERVAL_SECONDS 600s
 #define WEATHER_CHECK_WIFI_WAIT 5000
 
+// How long fetched coordinates and weather data are reused when the effect is started again
+#define WEATHER_COORDINATES_CACHE_MS (24 * 60 * 60 * 1000UL)
+#define WEATHER_DATA_CACHE_MS        (duration_cast<milliseconds>(WEATHER_INTERVAL_SECONDS).count() / 2)
+
 extern const uint8_t brokenclouds_start[]           asm("_binary_assets_bmp_brokenclouds_jpg_start");
 extern const uint8_t brokenclouds_end[]             asm("_binary_assets_bmp_brokenclouds_jpg_end");
 extern const uint8_t brokenclouds_night_start[]     asm("_binary_assets_bmp_brokencloudsnight_jpg_start");
@@ -126,6 +131,11 @@ class PatternWeather : public LEDStripEffect
 
 private:
 
+    // The Strings are written by the HTTP fetcher's callbacks and read by the network and drawing tasks,
+    // so they are only touched with dataMutex held.  It is never held while a fetch is queued, as cached
+    // responses invoke their callback right away.
+
+    std::mutex dataMutex;
     String strLocationName    = "";
     String strLocation        = "";
     String strCountryCode     = "";
@@ -213,19 +223,14 @@ private:
     }
 
     /**
-     * @brief Update the latitude and longitude for the
-     * selected city or zip code from the device configuration
-     *
-     * @return bool - true if the lat/log location is updated
+     * @brief Request the latitude and longitude for the
+     * selected city or zip code from the device configuration.
+     * Once they are in, the weather data for them is requested.
      */
-    bool updateCoordinates()
+    void updateCoordinates()
     {
-        HTTPClient http;
         String url;
 
-        if (!HasLocationChanged())
-            return false;
-
         const String& configLocation = g_ptrSystem->DeviceConfig().GetLocation();
         const String& configCountryCode = g_ptrSystem->DeviceConfig().GetCountryCode();
         const bool configLocationIsZip = g_ptrSystem->DeviceConfig().IsLocationZip();
@@ -237,54 +242,65 @@ private:
             url = "http://api.openweathermap.org/geo/1.0/direct"
                 "?q=" + urlEncode(configLocation) + "," + urlEncode(configCountryCode) + "&limit=1&appid=" + urlEncode(g_ptrSystem->DeviceConfig().GetOpenWeatherAPIKey());
 
-        http.begin(url);
-        int httpResponseCode = http.GET();
+        // The zip code API returns a single location, the other one an array of them
+        JsonDocument filter;
+        JsonObject filterCoordinates = configLocationIsZip ? filter.to<JsonObject>() : filter[0].to<JsonObject>();
+        filterCoordinates["lat"] = true;
+        filterCoordinates["lon"] = true;
 
-        if (httpResponseCode <= 0)
+        // The location goes along with the request, as the configuration may change while it's under way
+        g_ptrSystem->HTTPFetcher().FetchJSON(url, filter, [this, location = configLocation, countryCode = configCountryCode, configLocationIsZip](const HTTPResponse& response, JsonDocument& doc)
         {
-            debugE("Error fetching coordinates for location: %s", configLocation.c_str());
-            http.end();
-            return false;
-        }
+            if (!response.IsOK())
+            {
+                debugE("Error fetching coordinates for location: %s", location.c_str());
+                return;
+            }
 
-        auto doc = CreateJsonDocument();
-        deserializeJson(doc, http.getString());
-        JsonObject coordinates = configLocationIsZip ? doc.as<JsonObject>() : doc[0].as<JsonObject>();
+            JsonObject coordinates = configLocationIsZip ? doc.as<JsonObject>() : doc[0].as<JsonObject>();
 
-        strLatitude = coordinates["lat"].as<String>();
-        strLongitude = coordinates["lon"].as<String>();
+            {
+                std::lock_guard<std::mutex> guard(dataMutex);
 
-        http.end();
+                strLatitude = coordinates["lat"].as<String>();
+                strLongitude = coordinates["lon"].as<String>();
 
-        strLocation = configLocation;
-        strCountryCode = configCountryCode;
+                strLocation = location;
+                strCountryCode = countryCode;
+            }
 
-        return true;
+            getWeatherData();
+        }, this, WEATHER_COORDINATES_CACHE_MS);
     }
 
     /**
-     * @brief Get the forcast for Tomorrow from the API
+     * @brief Request the forcast for Tomorrow from the API
      *
      * Tommorow's expected high and low temperatures,
      * and an icon for tomorrow's weather forcast
-     *
-     * @param highTemp address to store the high temperature
-     * @param lowTemp address to store the low temperature
-     * @return bool - true if valid weather data retrieved
      */
-    bool getTomorrowTemps(float& highTemp, float& lowTemp)
+    void getTomorrowTemps()
     {
-        HTTPClient http;
         String url = "http://api.openweathermap.org/data/2.5/forecast"
-            "?lat=" + strLatitude + "&lon=" + strLongitude + "&cnt=16&appid=" + urlEncode(g_ptrSystem->DeviceConfig().GetOpenWeatherAPIKey());
-        http.begin(url);
-        int httpResponseCode = http.GET();
+            "?" + coordinatesQuery() + "&cnt=16&appid=" + urlEncode(g_ptrSystem->DeviceConfig().GetOpenWeatherAPIKey());
+
+        // The forecast is a big document, of which we only need the times, temperatures and icons
+        JsonDocument filter;
+        JsonObject filterEntry = filter["list"][0].to<JsonObject>();
+        filterEntry["dt"] = true;
+        filterEntry["main"]["temp_max"] = true;
+        filterEntry["main"]["temp_min"] = true;
+        filterEntry["weather"][0]["icon"] = true;
 
-        if (httpResponseCode > 0)
+        g_ptrSystem->HTTPFetcher().FetchJSON(url, filter, [this](const HTTPResponse& response, JsonDocument& doc)
         {
-            // Needs to be this large to process all the returned JSON
-            auto doc = CreateJsonDocument();
-            deserializeJson(doc, http.getString());
+            if (!response.IsOK())
+            {
+                std::lock_guard<std::mutex> guard(dataMutex);
+                debugE("Error fetching forecast data for location: %s in country: %s", strLocation.c_str(), strCountryCode.c_str());
+                return;
+            }
+
             JsonArray list = doc["list"];
 
             // Get tomorrow's date
@@ -297,8 +313,7 @@ private:
             float dailyMinimum = 999.0;
             float dailyMaximum = 0.0;
             int slot = 0;
-
-            iconTomorrow = "";
+            String icon;
 
             // Look for the temperature data for tomorrow
             for (size_t i = 0; i < list.size(); ++i)
@@ -328,47 +343,47 @@ private:
 
                     // Use the noon slot for the icon
                     if (slot == 4)
-                        iconTomorrow = entry["weather"][0]["icon"].as<String>();
+                        icon = entry["weather"][0]["icon"].as<String>();
                 }
             }
 
-            highTemp        = KelvinToLocal(dailyMaximum);
-            lowTemp         = KelvinToLocal(dailyMinimum);
+            highTomorrow    = KelvinToLocal(dailyMaximum);
+            loTomorrow      = KelvinToLocal(dailyMinimum);
 
-            debugI("Got tomorrow's temps: Lo %d, Hi %d, Icon %s", (int)lowTemp, (int)highTemp, iconTomorrow.c_str());
+            debugI("Got tomorrow's temps: Lo %d, Hi %d, Icon %s", (int)loTomorrow, (int)highTomorrow, icon.c_str());
 
-            http.end();
-            return true;
-        }
-        else
-        {
-            debugE("Error fetching forecast data for location: %s in country: %s", strLocation.c_str(), strCountryCode.c_str());
-            http.end();
-            return false;
-        }
+            std::lock_guard<std::mutex> guard(dataMutex);
+            iconTomorrow = icon;
+        }, this, WEATHER_DATA_CACHE_MS);
     }
 
     /**
-     * @brief Get the Weather Data from the API
+     * @brief Request the Weather Data from the API
      *
      * Current temperature, expected high and low temperatures,
-     * and an icon for the current weather
-     *
-     * @return bool - true if valid weather data retrieved
+     * and an icon for the current weather. Once they are in,
+     * tomorrow's forecast is requested.
      */
-    bool getWeatherData()
+    void getWeatherData()
     {
-        HTTPClient http;
-
         String url = "http://api.openweathermap.org/data/2.5/weather"
-            "?lat=" + strLatitude + "&lon=" + strLongitude + "&appid=" + urlEncode(g_ptrSystem->DeviceConfig().GetOpenWeatherAPIKey());
-        http.begin(url);
-        int httpResponseCode = http.GET();
-        if (httpResponseCode > 0)
+            "?" + coordinatesQuery() + "&appid=" + urlEncode(g_ptrSystem->DeviceConfig().GetOpenWeatherAPIKey());
+
+        JsonDocument filter;
+        filter["main"]["temp"] = true;
+        filter["main"]["temp_max"] = true;
+        filter["main"]["temp_min"] = true;
+        filter["weather"][0]["icon"] = true;
+        filter["name"] = true;
+
+        g_ptrSystem->HTTPFetcher().FetchJSON(url, filter, [this](const HTTPResponse& response, JsonDocument& jsonDoc)
         {
-            iconToday = "";
-            auto jsonDoc = CreateJsonDocument();
-            deserializeJson(jsonDoc, http.getString());
+            if (!response.IsOK())
+            {
+                std::lock_guard<std::mutex> guard(dataMutex);
+                debugE("Error fetching Weather data for location: %s in country: %s", strLocation.c_str(), strCountryCode.c_str());
+                return;
+            }
 
             // Once we have a non-zero temp we can start displaying things
             if (0 < jsonDoc["main"]["temp"])
@@ -378,28 +393,28 @@ private:
             highToday   = KelvinToLocal(jsonDoc["main"]["temp_max"]);
             loToday     = KelvinToLocal(jsonDoc["main"]["temp_min"]);
 
-            iconToday = jsonDoc["weather"][0]["icon"].as<String>();
-            debugI("Got today's temps: Now %d Lo %d, Hi %d, Icon %s", (int)temperature, (int)loToday, (int)highToday, iconToday.c_str());
+            String icon = jsonDoc["weather"][0]["icon"].as<String>();
+            debugI("Got today's temps: Now %d Lo %d, Hi %d, Icon %s", (int)temperature, (int)loToday, (int)highToday, icon.c_str());
 
-            const char * pszName = jsonDoc["name"];
-            if (pszName)
-                strLocationName = pszName;
+            {
+                std::lock_guard<std::mutex> guard(dataMutex);
 
-            http.end();
-            return true;
-        }
-        else
-        {
-            debugE("Error fetching Weather data for location: %s in country: %s", strLocation.c_str(), strCountryCode.c_str());
-            http.end();
-            return false;
-        }
+                iconToday = icon;
+
+                const char * pszName = jsonDoc["name"];
+                if (pszName)
+                    strLocationName = pszName;
+            }
+
+            getTomorrowTemps();
+        }, this, WEATHER_DATA_CACHE_MS);
     }
 
     /**
      * @brief Hook called from the Network Reader Thread
      * This drives the collection of the weather data.
-     *
+     * The requests themselves are executed by the HTTP
+     * fetcher, so this returns right away.
      */
     void UpdateWeather()
     {
@@ -412,10 +427,10 @@ private:
         // Only try to update if we have an API Key
         if (!g_ptrSystem->DeviceConfig().GetOpenWeatherAPIKey().isEmpty())
         {
-            updateCoordinates();
-
-            if (getWeatherData())
-                getTomorrowTemps(highTomorrow, loTomorrow);
+            if (HasLocationChanged())
+                updateCoordinates();
+            else
+                getWeatherData();
         }
     }
 
@@ -427,12 +442,27 @@ private:
      */
     bool HasLocationChanged()
     {
+        std::lock_guard<std::mutex> guard(dataMutex);
+
         bool locationChanged = g_ptrSystem->DeviceConfig().GetLocation() != strLocation;
         bool countryChanged = g_ptrSystem->DeviceConfig().GetCountryCode() != strCountryCode;
 
         return locationChanged || countryChanged;
     }
 
+    /**
+     * @brief Build the latitude and longitude query parameters
+     * for the weather API from the coordinates we have
+     *
+     * @return String - the lat and lon parameters
+     */
+    String coordinatesQuery()
+    {
+        std::lock_guard<std::mutex> guard(dataMutex);
+
+        return "lat=" + strLatitude + "&lon=" + strLongitude;
+    }
+
 public:
 
     /**
@@ -454,11 +484,13 @@ public:
 
     /**
      * @brief Destroy the Pattern Weather object
-     * Cancel the Network Reader thread for this index
+     * Cancel the Network Reader thread for this index,
+     * as well as any HTTP requests still under way
      */
     ~PatternWeather()
     {
         g_ptrSystem->NetworkReader().CancelReader(readerIndex);
+        g_ptrSystem->HTTPFetcher().CancelFetches(this);
     }
 
     /**
@@ -472,8 +504,9 @@ public:
         if (!LEDStripEffect::Init(gfx))
             return false;
 
-        // Register a Network Reader task with no interval.  Will manually flag in Draw()
-        readerIndex = g_ptrSystem->NetworkReader().RegisterReader([this] { UpdateWeather(); });
+        // Register a Network Reader task with no interval.  Will manually flag in Draw(). It only queues requests
+        //   with the HTTP fetcher, so it gets a tight budget, and runs first as its data is what we're showing.
+        readerIndex = g_ptrSystem->NetworkReader().RegisterReader([this] { UpdateWeather(); }, 0, false, { "Weather", ReaderPriority::High, 100 });
 
         return true;
     }
@@ -510,35 +543,44 @@ public:
             g_ptrSystem->NetworkReader().FlagReader(readerIndex);
         }
 
+        // Take copies of what the fetcher's callbacks may change while we draw
+
+        String strIconToday, strIconTomorrow, showLocation, showLocationName;
+        {
+            std::lock_guard<std::mutex> guard(dataMutex);
+
+            strIconToday     = iconToday;
+            strIconTomorrow  = iconTomorrow;
+            showLocation     = strLocation;
+            showLocationName = strLocationName;
+        }
+
         // Draw the graphics
-        auto iconEntry = weatherIcons.find(iconToday);
+        auto iconEntry = weatherIcons.find(strIconToday);
         if (iconEntry != weatherIcons.end())
         {
             auto icon = iconEntry->second;
             if (JDR_OK != TJpgDec.drawJpg(0, 10, icon.contents, icon.length))        // Draw the image
-                debugW("Could not display icon %s", iconToday.c_str());
+                debugW("Could not display icon %s", strIconToday.c_str());
         }
 
-        iconEntry = weatherIcons.find(iconTomorrow);
+        iconEntry = weatherIcons.find(strIconTomorrow);
         if (iconEntry != weatherIcons.end())
         {
             auto icon = iconEntry->second;
             if (JDR_OK != TJpgDec.drawJpg(xHalf+1, 10, icon.contents, icon.length))        // Draw the image
-                debugW("Could not display icon %s", iconTomorrow.c_str());
+                debugW("Could not display icon %s", strIconTomorrow.c_str());
         }
 
         // Print the town/city name
 
         int x = 0;
         int y = fontHeight + 1;
-        g()->setCursor(x, y);
-        g()->setTextColor(WHITE16);
-        String showLocation = strLocation;
         showLocation.toUpperCase();
         if (g_ptrSystem->DeviceConfig().GetOpenWeatherAPIKey().isEmpty())
-            g()->print("No API Key");
+            g()->DrawCachedText(x, y, "No API Key", CRGB::White);
         else
-            g()->print((strLocationName.isEmpty() ? showLocation : strLocationName).substring(0, (MATRIX_WIDTH - 2 * fontWidth)/fontWidth));
+            g()->DrawCachedText(x, y, (showLocationName.isEmpty() ? showLocation : showLocationName).substring(0, (MATRIX_WIDTH - 2 * fontWidth)/fontWidth), CRGB::White);
 
         // Display the temperature, right-justified
 
@@ -546,9 +588,7 @@ public:
         {
             String strTemp((int)temperature);
             x = MATRIX_WIDTH - fontWidth * strTemp.length();
-            g()->setCursor(x, y);
-            g()->setTextColor(g()->to16bit(CRGB(192,192,192)));
-            g()->print(strTemp);
+            g()->DrawCachedText(x, y, strTemp, CRGB(192,192,192));
         }
 
         // Draw the separator lines
@@ -568,17 +608,14 @@ public:
 
         // Draw the day of the week and tomorrow's day as well
 
-        g()->setTextColor(WHITE16);
-        g()->setCursor(0, MATRIX_HEIGHT);
-        g()->print(pszToday);
-        g()->setCursor(xHalf+2, MATRIX_HEIGHT);
-        g()->print(pszTomorrow);
+        g()->DrawCachedText(0, MATRIX_HEIGHT, pszToday, CRGB::White);
+        g()->DrawCachedText(xHalf+2, MATRIX_HEIGHT, pszTomorrow, CRGB::White);
 
         // Draw the temperature in lighter white
 
         if (dataReady)
         {
-            g()->setTextColor(g()->to16bit(CRGB(192,192,192)));
+            const CRGB tempColor(192,192,192);
             String strHi((int) highToday);
             String strLo((int) loToday);
 
@@ -586,12 +623,10 @@ public:
 
             x = xHalf - fontWidth * strHi.length();
             y = MATRIX_HEIGHT - fontHeight;
-            g()->setCursor(x,y);
-            g()->print(strHi);
+            g()->DrawCachedText(x, y, strHi, tempColor);
             x = xHalf - fontWidth * strLo.length();
             y+= fontHeight;
-            g()->setCursor(x,y);
-            g()->print(strLo);
+            g()->DrawCachedText(x, y, strLo, tempColor);
 
             // Draw tomorrow's HI and LO temperatures
 
@@ -599,12 +634,10 @@ public:
             strLo = String((int)loTomorrow);
             x = MATRIX_WIDTH - fontWidth * strHi.length();
             y = MATRIX_HEIGHT - fontHeight;
-            g()->setCursor(x,y);
-            g()->print(strHi);
+            g()->DrawCachedText(x, y, strHi, tempColor);
             x = MATRIX_WIDTH - fontWidth * strLo.length();
             y+= fontHeight;
-            g()->setCursor(x,y);
-            g()->print(strLo);
+            g()->DrawCachedText(x, y, strLo, tempColor);
         }
     }
 };
@@ -64,12 +64,13 @@ private:
     // Note: VSCode flags sqrt() for calling a non-constexpr builtin function, but it compiles and runs
     static constexpr float ImpactVelocityStart = sqrt(-2.0f * Gravity * StartHeight);
 
-    std::vector<double> ClockTimeSinceLastBounce;
-    std::vector<double> TimeSinceLastBounce;
-    std::vector<float>  Height;
-    std::vector<float>  ImpactVelocity;
-    std::vector<float>  Dampening;
-    std::vector<CRGB>   Colors;
+    // Per-ball state, _cBalls of each, allocated from the effect's arena in Init()
+    double * ClockTimeSinceLastBounce = nullptr;
+    double * TimeSinceLastBounce      = nullptr;
+    float  * Height                   = nullptr;
+    float  * ImpactVelocity           = nullptr;
+    float  * Dampening                = nullptr;
+    CRGB   * Colors                   = nullptr;
 
   public:
 
@@ -111,20 +112,38 @@ private:
         return 61;
     }
 
+    bool Prepare() override
+    {
+        // Colors doubles as the flag that all of the arrays were allocated
+        if (Colors)
+            return true;
+
+        auto& arena = Arena();
+
+        ClockTimeSinceLastBounce = arena.Allocate<double>(_cBalls);
+        TimeSinceLastBounce      = arena.Allocate<double>(_cBalls);
+        Height                   = arena.Allocate<float>(_cBalls);
+        ImpactVelocity           = arena.Allocate<float>(_cBalls);
+        Dampening                = arena.Allocate<float>(_cBalls);
+        Colors                   = arena.Allocate<CRGB>(_cBalls);
+
+        if (!ClockTimeSinceLastBounce || !TimeSinceLastBounce || !Height || !ImpactVelocity || !Dampening || !Colors)
+        {
+            debugE("Could not allocate state for %zu balls", _cBalls);
+            Colors = nullptr;
+            return false;
+        }
+
+        return true;
+    }
+
     bool Init(std::vector<std::shared_ptr<GFXBase>>& gfx) override
     {
-        if (!LEDStripEffect::Init(gfx))
+        if (!LEDStripEffect::Init(gfx) || !Prepare())
             return false;
 
         _cLength = gfx[0]->GetLEDCount();
 
-        ClockTimeSinceLastBounce.resize(_cBalls);
-        TimeSinceLastBounce.resize(_cBalls);
-        Height.resize(_cBalls);
-        ImpactVelocity.resize(_cBalls);
-        Dampening.resize(_cBalls);
-        Colors.resize(_cBalls);
-
         for (size_t i = 0; i < _cBalls; i++)
         {
             Height[i]                   = StartHeight;
@@ -1274,13 +1274,14 @@ protected:
     return CRGB(val, val * .30, val * .05);
   }
 
-  // Generate a vector of how bright each of the surrounding 8 LEDs on the unit circle should be
+  // Generate an array of how bright each of the surrounding 8 LEDs on the unit circle should be. This runs
+  // every frame, so it fills a fixed-size array rather than allocating a vector.
 
-  std::vector<float> led_brightness(float wandering_x, float wandering_y)
+  std::array<float, 8> led_brightness(float wandering_x, float wandering_y)
   {
-    const float sqrt2 = std::sqrt(2);
+    static const float sqrt2 = std::sqrt(2);
 
-    const std::vector<std::pair<float, float>> unit_circle_coords = {
+    static const std::pair<float, float> unit_circle_coords[8] = {
         {1, 0},
         { 1 / sqrt2,  1 / sqrt2},
         {0, 1},
@@ -1291,12 +1292,11 @@ protected:
         { 1 / sqrt2, -1 / sqrt2}
     };
 
-    std::vector<float> brightness_values;
+    std::array<float, 8> brightness_values;
 
-    for (const auto& coord : unit_circle_coords) {
-        float d = distance(wandering_x, wandering_y, coord.first, coord.second);
-        float brightness = std::max(1.0f - d, 0.0f);
-        brightness_values.push_back(brightness);
+    for (int i = 0; i < 8; i++) {
+        float d = distance(wandering_x, wandering_y, unit_circle_coords[i].first, unit_circle_coords[i].second);
+        brightness_values[i] = std::max(1.0f - d, 0.0f);
     }
 
     return brightness_values;
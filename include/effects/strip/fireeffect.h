@@ -35,12 +35,13 @@
 #include "musiceffect.h"
 #include "soundanalyzer.h"
 #include "systemcontainer.h"
+#include "firekernel.h"
 
 class FireEffect : public LEDStripEffect
 {
     void construct()
     {
-        heat.reset( psram_allocator<uint8_t>().allocate(CellCount()) );
+        _fire.Resize(CellCount());
     }
 
   protected:
@@ -53,7 +54,11 @@ class FireEffect : public LEDStripEffect
     bool    bReversed;          // If reversed we draw from 0 outwards
     bool    bMirrored;          // If mirrored we split and duplicate the drawing
 
-    std::unique_ptr<uint8_t []> heat;
+    FireKernel _fire;           // Heat cells for the flame
+
+    unsigned long _lastCoolMs  = 0;
+    unsigned long _lastDriftMs = 0;
+    unsigned long _lastSparkMs = 0;
 
     // When diffusing the fire upwards, these control how much to blend in from the cells below (ie: downward neighbors)
     // You can tune these coefficients to control how quickly and smoothly the fire spreads
@@ -63,8 +68,6 @@ class FireEffect : public LEDStripEffect
     static const uint8_t BlendNeighbor2 = 2;       // 2
     static const uint8_t BlendNeighbor3 = 0;       // 1
 
-    static const uint8_t BlendTotal = (BlendSelf + BlendNeighbor1 + BlendNeighbor2 + BlendNeighbor3);
-
     int CellCount() const { return LEDCount * CellsPerLED; }
 
   public:
@@ -123,6 +126,19 @@ class FireEffect : public LEDStripEffect
     {
     }
 
+    bool Prepare() override
+    {
+        return _fire.Allocate(Arena(ArenaMemory::PreferInternal));
+    }
+
+    bool Init(std::vector<std::shared_ptr<GFXBase>>& gfx) override
+    {
+        if (!LEDStripEffect::Init(gfx))
+            return false;
+
+        return Prepare();
+    }
+
     size_t DesiredFramesPerSecond() const override
     {
         return 45;
@@ -141,44 +157,36 @@ class FireEffect : public LEDStripEffect
             if (random(255) < Sparking)
             {
                 int y = CellCount() - 1 - random(SparkHeight * CellsPerLED);
-                heat[y] = random(200, 255);   // Can roll over which actually looks good!
+                _fire[y] = random(200, 255);   // Can roll over which actually looks good!
             }
         }
     }
 
     virtual void DrawFire()
     {
-        // First cool each cell by a little bit
+        // First cool each cell by a little bit, up to but not including Cooling
 
-        EVERY_N_MILLISECONDS(50)
+        if (IsIntervalDue(_lastCoolMs, 50))
         {
-          for (int i = 0; i < CellCount(); i++)
-          {
-            int coolingAmount = random(0, Cooling);
-            heat[i] = ::max(0, heat[i] - coolingAmount);
-          }
+            _fire.Cool(std::clamp(Cooling - 1, 0, 255));
         }
 
-        EVERY_N_MILLISECONDS(20)
+        if (IsIntervalDue(_lastDriftMs, 20))
         {
-          // Next drift heat up and diffuse it a little bit
-          for (int i = 0; i < CellCount(); i++)
-              heat[i] = std::min(255, (heat[i] * BlendSelf +
-                        heat[(i + 1) % CellCount()] * BlendNeighbor1 +
-                        heat[(i + 2) % CellCount()] * BlendNeighbor2 +
-                        heat[(i + 3) % CellCount()] * BlendNeighbor3)
-                        / BlendTotal);
+            // Next drift heat up and diffuse it a little bit
+            _fire.DriftToStart<BlendSelf, BlendNeighbor1, BlendNeighbor2, BlendNeighbor3>();
         }
 
         // Randomly ignite new sparks down in the flame kernel
 
-        EVERY_N_MILLISECONDS(20)
+        if (IsIntervalDue(_lastSparkMs, 20))
         {
             GenerateSparks(1.0);
         }
 
         // Finally, convert heat to a color
 
+        const uint8_t * heat = _fire.Heat();
         for (int i = 0; i < LEDCount; i++)
         {
             auto sum = 0;
@@ -335,6 +343,8 @@ class ClassicFireEffect : public LEDStripEffect
     bool _Reversed;
     int  _Cooling;
 
+    FireKernel _fire;
+
 public:
 
     ClassicFireEffect(bool mirrored = false, bool reversed = false, int cooling = 5)
@@ -367,6 +377,15 @@ public:
         return SetIfNotOverflowed(jsonDoc, jsonObject, __PRETTY_FUNCTION__);
     }
 
+    bool Init(std::vector<std::shared_ptr<GFXBase>>& gfx) override
+    {
+        if (!LEDStripEffect::Init(gfx))
+            return false;
+
+        _fire.Resize(_cLEDs);
+        return _fire.Allocate(Arena(ArenaMemory::PreferInternal));
+    }
+
     void Draw() override
     {
         Fire(_Cooling, 180, 5);
@@ -375,28 +394,14 @@ public:
 
     void Fire(int Cooling, int Sparking, int Sparks)
     {
-        static std::unique_ptr<uint8_t []> heat = make_unique_psram_array<uint8_t>(NUM_LEDS);
+        uint8_t * heat = _fire.Heat();
         setAllOnAllChannels(0,0,0);
 
-        // Step 1.  Cool down every cell a little
-        for (int i = 0; i < _cLEDs; i++)
-        {
-            int cooldown = random_range(0, Cooling);
-            if (cooldown > heat[i])
-            {
-                heat[i] = 0;
-            }
-            else
-            {
-                heat[i] = heat[i] - cooldown;
-            }
-        }
+        // Step 1.  Cool down every cell a little (by up to and including Cooling)
+        _fire.Cool(std::clamp(Cooling, 0, 255));
 
         // Step 2.  Heat from each cell drifts 'up' and diffuses a little
-        for (int k = _cLEDs - 1; k >= 3; k--)
-        {
-            heat[k] = (heat[k - 1] + heat[k - 2] + heat[k - 3]) / 3;
-        }
+        _fire.DriftToEnd<1, 1, 1>();
 
         // Step 3.  Randomly ignite new 'sparks' near the bottom
         for (int frame = 0; frame < Sparks; frame++)
@@ -554,7 +559,7 @@ public:
 
     void Draw() override
     {
-        float deltaTime = (float)g_Values.AppTime.LastFrameTime();
+        float deltaTime = (float)FrameTime();
         setAllOnAllChannels(0, 0, 0);
 
         float cooldown = random_range(0.0f, _Cooling) * deltaTime;
@@ -771,4 +776,4 @@ class BaseFireEffect : public LEDStripEffect
                 setPixelsOnAllChannels(!bReversed ? (2 * LEDCount - 1 - i) : LEDCount + i, 1, color, true);
         }
     }
-};
\ No newline at end of file
+};
\ No newline at end of file
@@ -0,0 +1,166 @@
+//+--------------------------------------------------------------------------
+//
+// File:        firekernel.h
+//
+// NightDriverStrip - (c) 2026 Plummer's Software LLC.  All Rights Reserved.
+//
+// This file is part of the NightDriver software project.
+//
+//    NightDriver is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    NightDriver is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with Nightdriver.  It is normally found in copying.txt
+//    If not, see <https://www.gnu.org/licenses/>.
+//
+// Description:
+//
+//    Heat simulation shared by the strip fire effects: a row of 8-bit heat
+//    cells that can be cooled and diffused along the flame.
+//
+//---------------------------------------------------------------------------
+
+#pragma once
+
+#include "globals.h"
+
+// FireKernel
+//
+// Runs the heat cells for one flame.  The cells are read and written several times per frame, so they are
+// taken from the effect's internal RAM arena, which only falls back to PSRAM for very long flames.  They're not
+// allocated until the effect calls Allocate() from its Init(), so fire effects that never run don't hold on to
+// internal RAM, and they go away with the effect's arena.  The other functions expect the cells to have been
+// allocated.
+//
+// Everything is 8-bit fixed point: cooling uses random8/scale8/qsub8 rather than random() and clamping, and
+// the diffusion weights are template parameters so the divide by their total becomes a multiply.  Diffusion
+// walks the cells in a straight line and only handles wrap-around for the last few, rather than taking a
+// modulo for every neighbor of every cell.
+
+class FireKernel
+{
+    uint8_t *   _pHeat = nullptr;
+    size_t      _cells = 0;
+
+  public:
+
+    FireKernel() = default;
+
+    explicit FireKernel(size_t cells)
+      : _cells(cells)
+    {
+    }
+
+    FireKernel(const FireKernel&) = delete;
+    FireKernel& operator=(const FireKernel&) = delete;
+
+    // Changes the number of cells.  Any existing heat is discarded, so the cells need to be allocated again.
+    // The old cells stay in the arena until the effect is unloaded, so this is meant to be called before Init().
+
+    void Resize(size_t cells)
+    {
+        if (cells == _cells)
+            return;
+
+        _pHeat = nullptr;
+        _cells = cells;
+    }
+
+    size_t size() const
+    {
+        return _cells;
+    }
+
+    // Allocates the cells from the arena if that hasn't happened yet; they start out cold.  Returns false if
+    // there's no memory for them at all.
+
+    bool Allocate(ScratchArena& arena)
+    {
+        if (_pHeat || _cells == 0)
+            return true;
+
+        _pHeat = arena.Allocate<uint8_t>(_cells);
+        if (!_pHeat)
+        {
+            debugE("Could not allocate %zu fire cells", _cells);
+            return false;
+        }
+
+        return true;
+    }
+
+    uint8_t * Heat()
+    {
+        return _pHeat;
+    }
+
+    uint8_t& operator[](size_t i)
+    {
+        return _pHeat[i];
+    }
+
+    // Cool
+    //
+    // Every cell loses a random amount of heat between 0 and maxCooling, inclusive. That relies on FastLED's
+    // FASTLED_SCALE8_FIXED (the default since 3.9), under which scale8(255, n) is n rather than n - 1.
+
+    void Cool(uint8_t maxCooling)
+    {
+        uint8_t * heat = Heat();
+
+        for (size_t i = 0; i < _cells; i++)
+            heat[i] = qsub8(heat[i], scale8(random8(), maxCooling));
+    }
+
+    // DriftToStart
+    //
+    // Heat drifts towards cell 0: each cell becomes the weighted average of itself and the three cells after it,
+    // with the last cells wrapping around to the start.  Cells are updated in place from the start, so this gives
+    // the same result as the modulo-indexed loop it replaces.
+
+    template <uint8_t Self, uint8_t Neighbor1, uint8_t Neighbor2, uint8_t Neighbor3>
+    void DriftToStart()
+    {
+        constexpr uint32_t Total = Self + Neighbor1 + Neighbor2 + Neighbor3;
+        static_assert(Total > 0, "At least one diffusion weight must be non-zero");
+
+        uint8_t * heat = Heat();
+        const size_t count = _cells;
+        const size_t body = count > 3 ? count - 3 : 0;
+
+        auto blend = [](uint32_t self, uint32_t n1, uint32_t n2, uint32_t n3) -> uint8_t
+        {
+            return (self * Self + n1 * Neighbor1 + n2 * Neighbor2 + n3 * Neighbor3) / Total;
+        };
+
+        for (size_t i = 0; i < body; i++)
+            heat[i] = blend(heat[i], heat[i + 1], heat[i + 2], heat[i + 3]);
+
+        for (size_t i = body; i < count; i++)
+            heat[i] = blend(heat[i], heat[(i + 1) % count], heat[(i + 2) % count], heat[(i + 3) % count]);
+    }
+
+    // DriftToEnd
+    //
+    // Heat drifts away from cell 0: from the fourth cell on, each cell becomes the weighted average of the three
+    // cells before it.  Cells are updated in place from the end, and the first three are left alone.
+
+    template <uint8_t Neighbor1, uint8_t Neighbor2, uint8_t Neighbor3>
+    void DriftToEnd()
+    {
+        constexpr uint32_t Total = Neighbor1 + Neighbor2 + Neighbor3;
+        static_assert(Total > 0, "At least one diffusion weight must be non-zero");
+
+        uint8_t * heat = Heat();
+
+        for (size_t k = _cells; k-- > 3; )
+            heat[k] = (heat[k - 1] * Neighbor1 + heat[k - 2] * Neighbor2 + heat[k - 3] * Neighbor3) / Total;
+    }
+};
@@ -295,17 +295,205 @@ class DrawableParticle : public Lifespan
      virtual void Render(const std::vector<std::shared_ptr<GFXBase>>& _GFX) = 0;
 };
 
+// ParticlePool
+//
+// Bounded ring of particles that replaces the std::deque the particle effects used to keep.  Slots are
+// allocated on the first spawn, so that effects which never run don't pay for them, and the ring doubles in
+// size when it fills up until it reaches its capacity.  An effect therefore only ever holds about as many
+// slots as it has had particles alive at once; once the ring has grown to that size, spawning and retiring
+// are O(1) and never touch the heap.  Particles are constructed in place, so types with const members and
+// virtual functions work as-is; they only need to be copy or move constructible so the ring can grow.
+//
+// Alongside the particles we keep a packed array of their expiry times, so aging out old particles walks a
+// small array of doubles instead of making two virtual calls per particle.  Like the deque it replaces, the
+// pool assumes particles are born roughly in the order they die, and retires them from the front.
+
+template <typename Type> class ParticlePool
+{
+    uint8_t *   _pSlots   = nullptr;
+    double *    _pExpiry  = nullptr;
+    size_t      _capacity;
+    size_t      _allocated = 0;
+    size_t      _head     = 0;
+    size_t      _count    = 0;
+
+    static constexpr size_t kInitialSlots = 16;
+
+    size_t SlotIndex(size_t i) const
+    {
+        size_t index = _head + i;
+        return index >= _allocated ? index - _allocated : index;
+    }
+
+    Type * Slot(size_t index) const
+    {
+        return reinterpret_cast<Type *>(_pSlots + index * sizeof(Type));
+    }
+
+    // Doubles the number of slots (up to the capacity), moving the live particles to the front of the new ring.
+    // If there's no memory for the bigger ring, the current one is left as it is and false is returned.
+
+    bool Grow()
+    {
+        size_t newSize = std::min(std::max(_allocated * 2, kInitialSlots), _capacity);
+
+        auto pSlots  = static_cast<uint8_t *>(TryPreferPSRAMAlloc(newSize * sizeof(Type)));
+        auto pExpiry = static_cast<double *>(TryPreferPSRAMAlloc(newSize * sizeof(double)));
+
+        if (!pSlots || !pExpiry)
+        {
+            free(pSlots);
+            free(pExpiry);
+            return false;
+        }
+
+        for (size_t i = 0; i < _count; i++)
+        {
+            size_t index = SlotIndex(i);
+            Type * pOld = Slot(index);
+
+            new (pSlots + i * sizeof(Type)) Type(std::move(*pOld));
+            pOld->~Type();
+            pExpiry[i] = _pExpiry[index];
+        }
+
+        free(_pSlots);
+        free(_pExpiry);
+
+        _pSlots    = pSlots;
+        _pExpiry   = pExpiry;
+        _allocated = newSize;
+        _head      = 0;
+
+        return true;
+    }
+
+  public:
+
+    template <typename Pool, typename Value> class iterator_base
+    {
+        Pool * _pPool;
+        size_t _index;
+
+      public:
+
+        iterator_base(Pool * pPool, size_t index) : _pPool(pPool), _index(index) {}
+
+        Value& operator*() const        { return (*_pPool)[_index]; }
+        Value* operator->() const       { return &(*_pPool)[_index]; }
+        iterator_base& operator++()     { _index++; return *this; }
+        iterator_base operator++(int)   { iterator_base tmp = *this; _index++; return tmp; }
+
+        bool operator==(const iterator_base& other) const { return _index == other._index; }
+        bool operator!=(const iterator_base& other) const { return _index != other._index; }
+    };
+
+    typedef iterator_base<ParticlePool<Type>, Type> iterator;
+    typedef iterator_base<const ParticlePool<Type>, const Type> const_iterator;
+
+    explicit ParticlePool(size_t capacity)
+      : _capacity(capacity)
+    {
+    }
+
+    ~ParticlePool()
+    {
+        clear();
+        free(_pSlots);
+        free(_pExpiry);
+    }
+
+    ParticlePool(const ParticlePool&) = delete;
+    ParticlePool& operator=(const ParticlePool&) = delete;
+
+    // Adds a particle at the back and returns it.  If the pool is full, the oldest particle is retired to make room.
+    // If the ring has to grow and there's no memory for that, the particle is dropped and nullptr is returned.
+
+    template <typename... Args>
+    Type * emplace_back(Args&&... args)
+    {
+        if (_count == _capacity)
+            pop_front();
+        else if (_count == _allocated && !Grow())
+            return nullptr;
+
+        size_t index = SlotIndex(_count);
+        Type * p = new (Slot(index)) Type(std::forward<Args>(args)...);
+        _pExpiry[index] = g_Values.AppTime.FrameStartTime() - p->Age() + p->TotalLifetime();
+        _count++;
+
+        return p;
+    }
+
+    void push_back(const Type& particle)
+    {
+        emplace_back(particle);
+    }
+
+    void push_back(Type&& particle)
+    {
+        emplace_back(std::move(particle));
+    }
+
+    void pop_front()
+    {
+        if (_count == 0)
+            return;
+
+        Slot(_head)->~Type();
+        _head = SlotIndex(1);
+        _count--;
+    }
+
+    // Retires particles from the front for as long as they have outlived their lifetime
+
+    void RetireExpired()
+    {
+        double now = g_Values.AppTime.FrameStartTime();
+
+        while (_count > 0 && _pExpiry[_head] <= now)
+            pop_front();
+    }
+
+    void clear()
+    {
+        while (_count > 0)
+            pop_front();
+        _head = 0;
+    }
+
+    Type& front()                                   { return *Slot(_head); }
+    const Type& front() const                       { return *Slot(_head); }
+    Type& operator[](size_t i)                      { return *Slot(SlotIndex(i)); }
+    const Type& operator[](size_t i) const          { return *Slot(SlotIndex(i)); }
+
+    size_t size() const                             { return _count; }
+    size_t capacity() const                         { return _capacity; }
+    bool empty() const                              { return _count == 0; }
+    bool full() const                               { return _count == _capacity; }
+
+    iterator begin()                                { return iterator(this, 0); }
+    iterator end()                                  { return iterator(this, _count); }
+    const_iterator begin() const                    { return const_iterator(this, 0); }
+    const_iterator end() const                      { return const_iterator(this, _count); }
+};
+
+// The most particles a ParticleSystem will keep alive at once; spawning beyond this retires the oldest
+
+const size_t cMaxParticles = 256;
+
 template <typename Type = DrawableParticle> class ParticleSystem
 {
   protected:
 
-    std::deque<Type> _allParticles;
+    ParticlePool<Type> _allParticles;
 
     // Once per frame we are called to update all particles, which includes aging out old ones
 
   public:
 
-    ParticleSystem<Type>()
+    ParticleSystem<Type>(size_t maxParticles = cMaxParticles)
+      : _allParticles(maxParticles)
     {
     }
 
@@ -313,8 +501,7 @@ template <typename Type = DrawableParticle> class ParticleSystem
     {
         debugV("ParticleSystemEffect::Draw for %d particles", _allParticles.size());
 
-        while (_allParticles.size() > 0 && _allParticles.front().Age() >= _allParticles.front().TotalLifetime())
-            _allParticles.pop_front();
+        _allParticles.RetireExpired();
 
         while (_allParticles.size() > _gfx[0]->GetLEDCount())
             _allParticles.pop_front();
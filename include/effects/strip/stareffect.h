@@ -31,8 +31,6 @@
 
 #pragma once
 
-#include <deque>
-
 #include "particles.h"
 
 const int cMaxNewStarsPerFrame = 144;
@@ -420,7 +418,7 @@ template <typename ObjectType> class BeatStarterEffect : public BeatEffectBase
 template <typename StarType> class StarryNightEffect : public LEDStripEffect
 {
   protected:
-    std::deque<StarType>         _allParticles;
+    ParticlePool<StarType>       _allParticles;
     const CRGBPalette16         _palette;
     float                        _newStarProbability;
     float                        _starSize;
@@ -443,6 +441,7 @@ template <typename StarType> class StarryNightEffect : public LEDStripEffect
                                 float musicFactor = 1.0,
                                 CRGB skyColor = CRGB::Black)
       : LEDStripEffect(EFFECT_STRIP_STARRY_NIGHT, strName),
+        _allParticles(cMaxStars),
         _palette(palette),
         _newStarProbability(probability),
         _starSize(starSize),
@@ -456,6 +455,7 @@ template <typename StarType> class StarryNightEffect : public LEDStripEffect
 
     StarryNightEffect<StarType>(const JsonObjectConst& jsonObject)
       : LEDStripEffect(jsonObject),
+        _allParticles(cMaxStars),
         _palette(jsonObject[PTY_PALETTE].as<CRGBPalette16>()),
         _newStarProbability(jsonObject["spb"]),
         _starSize(jsonObject[PTY_SIZE]),
@@ -510,14 +510,15 @@ template <typename StarType> class StarryNightEffect : public LEDStripEffect
 
             constexpr auto kProbabilitySpan = 1.0;
 
-            if (g_Analyzer._VU > 0)
+            // Once the pool is full, new stars are dropped rather than retiring older ones before they get painted
+            if (g_Analyzer._VU > 0 && !_allParticles.full())
             {
                 if (random_range(0.0, kProbabilitySpan) < g_Values.AppTime.LastFrameTime() * prob)
                 {
-                    StarType newstar(_palette, _blendType, _maxSpeed * _musicFactor, _starSize);
+                    StarType * pNewStar = _allParticles.emplace_back(_palette, _blendType, _maxSpeed * _musicFactor, _starSize);
                     // This always starts stars on even pixel boundaries so they look like the desired width if not moving
-                    newstar._iPos = (int) random_range(0U, _cLEDs-1-starWidth);
-                    _allParticles.push_back(newstar);
+                    if (pNewStar)
+                        pNewStar->_iPos = (int) random_range(0U, _cLEDs-1-starWidth);
                 }
             }
         }
@@ -526,13 +527,9 @@ template <typename StarType> class StarryNightEffect : public LEDStripEffect
 
     virtual void Update()
     {
-        // Any particles that have lived their lifespan can be removed.  They should be found at the back of the array
-        while (_allParticles.size() > 0 && (_allParticles.front().Age() >= _allParticles.front().TotalLifetime()))
-            _allParticles.pop_front();
-
-        // If we've created too many stars, prune the newest first, before they get painted
-        while (_allParticles.size() > cMaxStars)
-            _allParticles.pop_back();
+        // Any particles that have lived their lifespan can be removed.  They should be found at the front of the pool.
+        // The pool never holds more than cMaxStars, so there's no longer any need to prune the newest ones here.
+        _allParticles.RetireExpired();
     }
 
     void Draw() override
@@ -0,0 +1,128 @@
+//+--------------------------------------------------------------------------
+//
+// File:        effectsources.h
+//
+// NightDriverStrip - (c) 2026 Plummer's Software LLC.  All Rights Reserved.
+//
+// This file is part of the NightDriver software project.
+//
+//    NightDriver is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    NightDriver is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with Nightdriver.  It is normally found in copying.txt
+//    If not, see <https://www.gnu.org/licenses/>.
+//
+// Description:
+//
+//    Sources of time, randomness and audio for effects, and the frame hash
+//    recording that uses them.  Normally effects run on the live clock and
+//    microphone; for a recording, an effect is given ReplayEffectSources
+//    instead, so that what it draws depends on nothing but the seed it's
+//    started with.  The CRC of every frame it draws can then be compared
+//    to that of an earlier build, to prove an optimization didn't change
+//    the effect's output.
+//
+//---------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// The longest frame hash recording we accept; every frame takes four bytes
+#define FRAME_HASH_MAX_FRAMES   1800
+
+// EffectSources
+//
+// The clock an effect animates by. This base class passes through the live clock; effects get to it through
+//   the Millis(), AppTime() and FrameTime() helpers in LEDStripEffect, which makes it replaceable.
+
+class EffectSources
+{
+  public:
+    virtual ~EffectSources() = default;
+
+    virtual unsigned long Millis() const;           // Like millis()
+    virtual double AppTime() const;                 // Like g_Values.AppTime.FrameStartTime()
+    virtual double FrameTime() const;               // Like g_Values.AppTime.LastFrameTime()
+
+    // The sources effects use when they haven't been given any
+    static const EffectSources & Live();
+};
+
+// ReplayEffectSources
+//
+// Sources for reproducible output: a clock that advances a fixed step per frame regardless of how long frames
+//   actually take, FastLED's random number generator seeded with a fixed value, and scripted audio levels. Only
+//   effects that take their random numbers from random8(), random16() and friends replay exactly; Arduino's
+//   random() stays on the hardware RNG.
+//
+//   While a replay is running (between Begin() and End()), the audio sampler leaves the audio variables alone,
+//   and FastLED's random number generator is shared with everything else that draws from it.
+
+class ReplayEffectSources : public EffectSources
+{
+    uint32_t _seed;
+    uint32_t _frameMs;
+    uint32_t _frame = 0;
+    uint16_t _savedRandom16Seed = 0;
+
+    void ApplyAudio() const;
+
+  public:
+
+    explicit ReplayEffectSources(uint32_t seed, uint32_t frameMs = 1000 / 30)
+      : _seed(seed),
+        _frameMs(frameMs)
+    {}
+
+    unsigned long Millis() const override
+    {
+        return _frame * _frameMs;
+    }
+
+    double AppTime() const override
+    {
+        return _frame * _frameMs / 1000.0;
+    }
+
+    double FrameTime() const override
+    {
+        return _frameMs / 1000.0;
+    }
+
+    // Seeds FastLED's random number generator and takes over the audio variables. Call before starting the effect.
+    void Begin();
+
+    // Moves the clock and the audio script on to the next frame
+    void NextFrame();
+
+    // Restores the random number generator's seed and hands the audio variables back to the sampler
+    void End();
+};
+
+// FrameHashRecording
+//
+// A request for, and the result of, replaying an effect: the CRC32 of all LED buffers after each frame drawn
+
+struct FrameHashRecording
+{
+    size_t   effectIndex = 0;
+    uint32_t seed        = 0;
+    size_t   frameCount  = 0;
+    bool     failed      = false;
+    std::vector<uint32_t> hashes;
+
+    bool IsComplete() const
+    {
+        return failed || hashes.size() >= frameCount;
+    }
+};
@@ -0,0 +1,93 @@
+//+--------------------------------------------------------------------------
+//
+// File:        effectstore.h
+//
+// NightDriverStrip - (c) 2026 Plummer's Software LLC.  All Rights Reserved.
+//
+// This file is part of the NightDriver software project.
+//
+//    NightDriver is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    NightDriver is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with Nightdriver.  It is normally found in copying.txt
+//    If not, see <https://www.gnu.org/licenses/>.
+//
+// Description:
+//
+//    Binary store for the effect configuration.  Instead of rewriting one
+//    big JSON file whenever anything changes, the configuration is kept as
+//    a log of CRC-protected records: one manifest record with the global
+//    effect settings, and one record per effect holding its configuration
+//    as MessagePack.  A save only appends the records that changed; the
+//    file is compacted (written to a temporary file that then replaces it)
+//    when the effect list changes shape or the log has grown too long.
+//
+//    Because records are only ever appended, a power cut during a save can
+//    at most cost the record being written; the loader stops at the first
+//    damaged record and uses the latest intact copy of every slot.
+//
+//---------------------------------------------------------------------------
+
+#pragma once
+
+#include <vector>
+#include <ArduinoJson.h>
+
+#include "effectmanager.h"
+
+#define EFFECTS_STORE_FILE          "/effects.bin"
+#define EFFECTS_STORE_TEMP_FILE     "/effects.tmp"
+
+// Bump this when the record layout changes; stores written with another format version are ignored
+#define EFFECTS_STORE_FORMAT        1
+
+// EffectConfigStore
+//
+// Reads and writes the effect configuration in the binary format described above.  Load() rebuilds the
+// same JSON layout that EffectManager::SerializeToJSON() produces, so the EffectManager can be restored
+// through its regular DeserializeFromJSON() path.
+
+class EffectConfigStore
+{
+    std::vector<uint32_t> _slotCRCs;        // CRC of the last record written for every effect slot
+    uint32_t _manifestCRC   = 0;            // CRC of the last manifest record written
+    uint32_t _nextSequence  = 1;            // Sequence number for the next record we write
+    size_t   _fileSize      = 0;            // Current size of the store file
+    size_t   _liveSize      = 0;            // Bytes in the store file taken by current (not superseded) records
+    bool     _inSync        = false;        // Whether the members above reflect what's in the store file
+
+    size_t   _recordsWritten = 0;
+    size_t   _compactions    = 0;
+
+    bool WriteFile(const PackedEffectConfig& manifest, const std::vector<PackedEffectConfig>& effectConfigs);
+    bool AppendRecords(const PackedEffectConfig& manifest, const std::vector<PackedEffectConfig>& effectConfigs);
+
+  public:
+
+    // Loads the effect configuration from the store into jsonDoc. Returns false if there's no usable store.
+    bool Load(JsonDocument& jsonDoc);
+
+    // Persists the effect manager's configuration, writing only what changed since the last Load() or Save()
+    bool Save(const EffectManager& effectManager);
+
+    // Removes the store from flash
+    void Remove();
+
+    size_t RecordsWritten() const
+    {
+        return _recordsWritten;
+    }
+
+    size_t Compactions() const
+    {
+        return _compactions;
+    }
+};
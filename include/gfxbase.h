@@ -64,12 +64,15 @@
 
 #pragma once
 
+#include <atomic>
 #include <stdexcept>
 #include "Adafruit_GFX.h"
 #include "pixeltypes.h"
 #include "effects/matrix/Boid.h"
 #include "effects/matrix/Vector.h"
 #include "globals.h"
+#include "palettetable.h"
+#include "textcache.h"
 #include <memory>
 
 #if USE_HUB75
@@ -97,6 +100,23 @@
     };
 #endif
 
+// DirtyRect
+//
+// The part of a device's buffer that changed in a frame, in buffer columns and rows; x1 and y1 are exclusive.
+
+struct DirtyRect
+{
+    size_t x0 = 0;
+    size_t y0 = 0;
+    size_t x1 = 0;
+    size_t y1 = 0;
+
+    bool IsEmpty() const
+    {
+        return x1 <= x0 || y1 <= y0;
+    }
+};
+
 class GFXBase : public Adafruit_GFX
 {
 #if USE_NOISE
@@ -140,12 +160,33 @@ protected:
     TBlendType _currentBlendType = LINEARBLEND;
     CRGBPalette16 _currentPalette;
     CRGBPalette16 _targetPalette;
+    PaletteTable _currentPaletteTable;     // _currentPalette expanded to 256 entries for ColorFromCurrentPalette
     String _currentPaletteName;
 
     #if USE_NOISE
         std::unique_ptr<Noise> _ptrNoise;
     #endif
 
+    // With HIGH_PRECISION_FRAMEBUFFER, the low 8 bits of every color channel, leds holding the high 8. The helpers
+    // below that fade and move pixels maintain them, and the pixel setters clear them. Effects that write leds
+    // directly leave the fraction as it was, which is off by less than one level; the output stage ignores the
+    // fractions of channels that are zero, so a pixel set to black that way stays black.
+    std::unique_ptr<CRGB[]> _ledFractions;
+
+    void ClearFraction(size_t i) const
+    {
+        if (_ledFractions)
+            _ledFractions[i] = CRGB::Black;
+    }
+
+    // With TRACK_DIRTY_REGIONS, a copy of the last frame that UpdateDirtyRect() compares the next one to
+    std::unique_ptr<CRGB[]> _lastFrame;
+    bool _lastFrameValid = false;
+    DirtyRect _dirtyRect;
+    std::atomic<uint32_t> _contentVersion = 0;
+
+    TextCache _textCache;
+
     static constexpr int _heatColorsPaletteIndex = 6;
     static constexpr int _randomPaletteIndex = 9;
 
@@ -174,6 +215,100 @@ public:
         return _currentPalette;
     }
 
+    const PaletteTable &GetCurrentPaletteTable() const
+    {
+        return _currentPaletteTable;
+    }
+
+    // UpdateDirtyRect
+    //
+    // Called after a frame has been drawn. Finds the rectangle in which it differs from the frame before, and bumps
+    // the content version if there is any difference. Without a copy of the last frame to compare to, the whole
+    // frame counts as changed.
+
+    void UpdateDirtyRect()
+    {
+        if (!_lastFrame || !_lastFrameValid)
+        {
+            if (_lastFrame)
+            {
+                memcpy(_lastFrame.get(), leds, sizeof(CRGB) * _width * _height);
+                _lastFrameValid = true;
+            }
+
+            _dirtyRect = { 0, 0, _width, _height };
+            _contentVersion++;
+            return;
+        }
+
+        DirtyRect dirty = { _width, _height, 0, 0 };
+
+        for (size_t y = 0; y < _height; y++)
+        {
+            const CRGB *pRow = leds + y * _width;
+            CRGB *pLastRow = _lastFrame.get() + y * _width;
+
+            if (memcmp(pRow, pLastRow, sizeof(CRGB) * _width) == 0)
+                continue;
+
+            size_t x0 = 0;
+            while (pRow[x0] == pLastRow[x0])
+                x0++;
+
+            size_t x1 = _width;
+            while (pRow[x1 - 1] == pLastRow[x1 - 1])
+                x1--;
+
+            memcpy(pLastRow + x0, pRow + x0, sizeof(CRGB) * (x1 - x0));
+
+            dirty.x0 = std::min(dirty.x0, x0);
+            dirty.x1 = std::max(dirty.x1, x1);
+            dirty.y0 = std::min(dirty.y0, y);
+            dirty.y1 = y + 1;
+        }
+
+        _dirtyRect = dirty;
+        if (!dirty.IsEmpty())
+            _contentVersion++;
+    }
+
+    // What changed in the last frame, as found by UpdateDirtyRect()
+    const DirtyRect &GetDirtyRect() const
+    {
+        return _dirtyRect;
+    }
+
+    // Changes whenever a frame differs from the one before, so other tasks can tell if there's anything new to send
+    uint32_t GetContentVersion() const
+    {
+        return _contentVersion;
+    }
+
+    // Brings pBuffer, which holds the frame before the last one, up to date with the last one by copying just the
+    // dirty rectangle. Returns false if that's not possible because we don't keep a copy of the last frame.
+    bool RestoreDirtyRect(CRGB *pBuffer) const
+    {
+        if (!_lastFrame || !_lastFrameValid)
+            return false;
+
+        if (_dirtyRect.IsEmpty())
+            return true;
+
+        for (size_t y = _dirtyRect.y0; y < _dirtyRect.y1; y++)
+        {
+            size_t offset = y * _width + _dirtyRect.x0;
+            memcpy(pBuffer + offset, _lastFrame.get() + offset, sizeof(CRGB) * (_dirtyRect.x1 - _dirtyRect.x0));
+        }
+
+        return true;
+    }
+
+    // The low 8 bits per color channel, or nullptr if the framebuffer isn't high precision
+    const CRGB *GetLedFractions() const
+    {
+        return _ledFractions.get();
+    }
+
     virtual size_t GetLEDCount() const
     {
         return _width * _height;
@@ -237,7 +372,84 @@ public:
             memset(leds, 0, sizeof(CRGB) * _width * _height);
         else
             fill_solid(leds, _width * _height, color);
+
+        if (_ledFractions)
+            memset(_ledFractions.get(), 0, sizeof(CRGB) * _width * _height);
+    }
+
+    // ScalePixel, AddPixel and CopyPixel
+    //
+    // Equivalents of leds[i].nscale8(scale), leds[i] += leds[j] and leds[i] = leds[j] that keep the extra
+    // precision of a high precision framebuffer.
+
+    void ScalePixel(uint16_t i, uint8_t scale) const
+    {
+        if (!_ledFractions)
+        {
+            leds[i].nscale8(scale);
+            return;
+        }
+
+        CRGB &color = leds[i];
+        CRGB &fraction = _ledFractions[i];
+        for (int c = 0; c < 3; c++)
+        {
+            uint32_t value = (((color[c] << 8) | fraction[c]) * (scale + 1)) >> 8;
+            color[c] = value >> 8;
+            fraction[c] = value & 0xFF;
+        }
+    }
+
+    void AddPixel(uint16_t i, uint16_t j) const
+    {
+        if (!_ledFractions)
+        {
+            leds[i] += leds[j];
+            return;
+        }
+
+        CRGB &color = leds[i];
+        CRGB &fraction = _ledFractions[i];
+        for (int c = 0; c < 3; c++)
+        {
+            uint32_t value = ((color[c] << 8) | fraction[c]) + ((leds[j][c] << 8) | _ledFractions[j][c]);
+            value = std::min(value, 0xFFFFu);
+            color[c] = value >> 8;
+            fraction[c] = value & 0xFF;
+        }
+    }
+
+    void CopyPixel(uint16_t i, uint16_t j) const
+    {
+        leds[i] = leds[j];
+        if (_ledFractions)
+            _ledFractions[i] = _ledFractions[j];
     }
+
+    // DrawCachedText
+    //
+    // Like setCursor(x, y), setTextColor() and print(text) with the current font, but the rendering of the text is
+    // cached, so that strings that are drawn every frame only have their glyphs unpacked once. Falls back to
+    // print() for the built-in font, which setFont() selects with nullptr.
+
+    void DrawCachedText(int16_t x, int16_t y, const String &text, CRGB color)
+    {
+        if (!gfxFont)
+        {
+            setCursor(x, y);
+            setTextColor(to16bit(color));
+            print(text);
+            return;
+        }
+
+        const RenderedText &rendered = _textCache.Get(gfxFont, text);
+
+        for (uint16_t ty = 0; ty < rendered.height; ty++)
+            for (uint16_t tx = 0; tx < rendered.width; tx++)
+                if (rendered.IsSet(tx, ty))
+                    drawPixel(x + rendered.x0 + tx, y + rendered.y0 + ty, color);
+    }
+
     virtual bool isValidPixel(uint x, uint y) const
     {
         // Check that the pixel location is within the matrix's bounds
@@ -318,13 +530,19 @@ public:
     virtual void drawPixel(int16_t x, int16_t y, CRGB color)
     {
         if (isValidPixel(x, y))
+        {
             leds[XY(x, y)] = color;
+            ClearFraction(XY(x, y));
+        }
     }
 
     void drawPixel(int16_t x, int16_t y, uint16_t color) override
     {
         if (isValidPixel(x, y))
+        {
             leds[XY(x, y)] = from16Bit(color);
+            ClearFraction(XY(x, y));
+        }
     }
 
     virtual void fillLeds(std::unique_ptr<CRGB[]> &pLEDs)
@@ -340,7 +558,10 @@ public:
     virtual void setPixel(int16_t x, int16_t y, uint16_t color)
     {
         if (isValidPixel(x, y))
+        {
             leds[XY(x, y)] = from16Bit(color);
+            ClearFraction(XY(x, y));
+        }
         else
             debugE("Invalid setPixel request: x=%d, y=%d, NUM_LEDS=%d", x, y, NUM_LEDS);
     }
@@ -348,7 +569,10 @@ public:
     virtual void setPixel(int16_t x, int16_t y, CRGB color)
     {
         if (isValidPixel(x, y))
+        {
             leds[XY(x, y)] = color;
+            ClearFraction(XY(x, y));
+        }
         else
             debugE("Invalid setPixel request: x=%d, y=%d, NUM_LEDS=%d", x, y, NUM_LEDS);
     }
@@ -365,7 +589,10 @@ public:
     virtual void setPixel(int x, CRGB color)
     {
         if (isValidPixel(x))
+        {
             leds[x] = color;
+            ClearFraction(x);
+        }
         else
             debugE("Invalid setPixel request: x=%d, NUM_LEDS=%d", x, NUM_LEDS);
     }
@@ -604,6 +831,9 @@ public:
         ChangePalettePeriodically();
         uint8_t maxChanges = 24;
         nblendPaletteTowardPalette(_currentPalette, _targetPalette, maxChanges);
+
+        // Only re-expands if the crossfade actually changed something
+        _currentPaletteTable.Update(_currentPalette, _currentBlendType);
     }
 
     void RandomPalette()
@@ -623,6 +853,7 @@ public:
         _currentPalette = palette;
         _targetPalette = palette;
         _currentPaletteName = "Custom";
+        _currentPaletteTable.Update(_currentPalette, _currentBlendType);
     }
 
     // Note that this function may recurse without
@@ -685,6 +916,7 @@ public:
             break;
         }
         _currentPalette = _targetPalette;
+        _currentPaletteTable.Update(_currentPalette, _currentBlendType);
     }
 
     void setPalette(const String& paletteName)
@@ -905,23 +1137,23 @@ public:
         { // from the outside to the inside
             for (int i = x - d; i <= x + d; i++)
             {
-                leds[XY(i, y - d)] += leds[XY(i + 1, y - d)]; // lowest row to the right
-                leds[XY(i, y - d)].nscale8(dimm);
+                AddPixel(XY(i, y - d), XY(i + 1, y - d)); // lowest row to the right
+                ScalePixel(XY(i, y - d), dimm);
             }
             for (int i = y - d; i <= y + d; i++)
             {
-                leds[XY(x + d, i)] += leds[XY(x + d, i + 1)]; // right colum up
-                leds[XY(x + d, i)].nscale8(dimm);
+                AddPixel(XY(x + d, i), XY(x + d, i + 1)); // right colum up
+                ScalePixel(XY(x + d, i), dimm);
             }
             for (int i = x + d; i >= x - d; i--)
             {
-                leds[XY(i, y + d)] += leds[XY(i - 1, y + d)]; // upper row to the left
-                leds[XY(i, y + d)].nscale8(dimm);
+                AddPixel(XY(i, y + d), XY(i - 1, y + d)); // upper row to the left
+                ScalePixel(XY(i, y + d), dimm);
             }
             for (int i = y + d; i >= y - d; i--)
             {
-                leds[XY(x - d, i)] += leds[XY(x - d, i - 1)]; // left colum down
-                leds[XY(x - d, i)].nscale8(dimm);
+                AddPixel(XY(x - d, i), XY(x - d, i - 1)); // left colum down
+                ScalePixel(XY(x - d, i), dimm);
             }
         }
     }
@@ -946,24 +1178,24 @@ public:
             while (a >= b)
             {
                 // move them out one pixel on the radius
-                leds[XY(a + centerX, b + centerY)]   = leds[XY(nextA + centerX, nextB + centerY)];
-                leds[XY(b + centerX, a + centerY)]   = leds[XY(nextB + centerX, nextA + centerY)];
-                leds[XY(-a + centerX, b + centerY)]  = leds[XY(-nextA + centerX, nextB + centerY)];
-                leds[XY(-b + centerX, a + centerY)]  = leds[XY(-nextB + centerX, nextA + centerY)];
-                leds[XY(-a + centerX, -b + centerY)] = leds[XY(-nextA + centerX, -nextB + centerY)];
-                leds[XY(-b + centerX, -a + centerY)] = leds[XY(-nextB + centerX, -nextA + centerY)];
-                leds[XY(a + centerX, -b + centerY)]  = leds[XY(nextA + centerX, -nextB + centerY)];
-                leds[XY(b + centerX, -a + centerY)]  = leds[XY(nextB + centerX, -nextA + centerY)];
+                CopyPixel(XY(a + centerX, b + centerY), XY(nextA + centerX, nextB + centerY));
+                CopyPixel(XY(b + centerX, a + centerY), XY(nextB + centerX, nextA + centerY));
+                CopyPixel(XY(-a + centerX, b + centerY), XY(-nextA + centerX, nextB + centerY));
+                CopyPixel(XY(-b + centerX, a + centerY), XY(-nextB + centerX, nextA + centerY));
+                CopyPixel(XY(-a + centerX, -b + centerY), XY(-nextA + centerX, -nextB + centerY));
+                CopyPixel(XY(-b + centerX, -a + centerY), XY(-nextB + centerX, -nextA + centerY));
+                CopyPixel(XY(a + centerX, -b + centerY), XY(nextA + centerX, -nextB + centerY));
+                CopyPixel(XY(b + centerX, -a + centerY), XY(nextB + centerX, -nextA + centerY));
 
                 // dim them
-                leds[XY(a + centerX, b + centerY)].nscale8(dimm);
-                leds[XY(b + centerX, a + centerY)].nscale8(dimm);
-                leds[XY(-a + centerX, b + centerY)].nscale8(dimm);
-                leds[XY(-b + centerX, a + centerY)].nscale8(dimm);
-                leds[XY(-a + centerX, -b + centerY)].nscale8(dimm);
-                leds[XY(-b + centerX, -a + centerY)].nscale8(dimm);
-                leds[XY(a + centerX, -b + centerY)].nscale8(dimm);
-                leds[XY(b + centerX, -a + centerY)].nscale8(dimm);
+                ScalePixel(XY(a + centerX, b + centerY), dimm);
+                ScalePixel(XY(b + centerX, a + centerY), dimm);
+                ScalePixel(XY(-a + centerX, b + centerY), dimm);
+                ScalePixel(XY(-b + centerX, a + centerY), dimm);
+                ScalePixel(XY(-a + centerX, -b + centerY), dimm);
+                ScalePixel(XY(-b + centerX, -a + centerY), dimm);
+                ScalePixel(XY(a + centerX, -b + centerY), dimm);
+                ScalePixel(XY(b + centerX, -a + centerY), dimm);
 
                 b++;
                 if (radiusError < 0)
@@ -995,12 +1227,12 @@ public:
         {
             for (int y = fromY; y < toY; y++)
             {
-                leds[XY(x, y)] += leds[XY(x - 1, y)];
-                leds[XY(x, y)].nscale8(scale);
+                AddPixel(XY(x, y), XY(x - 1, y));
+                ScalePixel(XY(x, y), scale);
             }
         }
         for (int y = fromY; y < toY; y++)
-            leds[XY(0, y)].nscale8(scale);
+            ScalePixel(XY(0, y), scale);
     }
 
     // give it a linear tail to the left
@@ -1010,12 +1242,12 @@ public:
         {
             for (int y = fromY; y < toY; y++)
             {
-                leds[XY(x, y)] += leds[XY(x + 1, y)];
-                leds[XY(x, y)].nscale8(scale);
+                AddPixel(XY(x, y), XY(x + 1, y));
+                ScalePixel(XY(x, y), scale);
             }
         }
         for (int y = fromY; y < toY; y++)
-            leds[XY(0, y)].nscale8(scale);
+            ScalePixel(XY(0, y), scale);
     }
 
     // give it a linear tail downwards
@@ -1025,12 +1257,12 @@ public:
         {
             for (int y = 1; y < _height; y++)
             {
-                leds[XY(x, y)] += leds[XY(x, y - 1)];
-                leds[XY(x, y)].nscale8(scale);
+                AddPixel(XY(x, y), XY(x, y - 1));
+                ScalePixel(XY(x, y), scale);
             }
         }
         for (int x = 0; x < _width; x++)
-            leds[XY(x, 0)].nscale8(scale);
+            ScalePixel(XY(x, 0), scale);
     }
 
     // give it a linear tail upwards
@@ -1040,12 +1272,12 @@ public:
         {
             for (int y = _height - 2; y >= 0; y--)
             {
-                leds[XY(x, y)] += leds[XY(x, y + 1)];
-                leds[XY(x, y)].nscale8(scale);
+                AddPixel(XY(x, y), XY(x, y + 1));
+                ScalePixel(XY(x, y), scale);
             }
         }
         for (int x = 0; x < _width; x++)
-            leds[XY(x, _height - 1)].nscale8(scale);
+            ScalePixel(XY(x, _height - 1), scale);
     }
 
     // give it a linear tail up and to the left
@@ -1055,14 +1287,14 @@ public:
         {
             for (int y = _height - 2; y >= 0; y--)
             {
-                leds[XY(x, y)] += leds[XY(x + 1, y + 1)];
-                leds[XY(x, y)].nscale8(scale);
+                AddPixel(XY(x, y), XY(x + 1, y + 1));
+                ScalePixel(XY(x, y), scale);
             }
         }
         for (int x = 0; x < _width; x++)
-            leds[XY(x, _height - 1)].nscale8(scale);
+            ScalePixel(XY(x, _height - 1), scale);
         for (int y = 0; y < _height; y++)
-            leds[XY(_width - 1, y)].nscale8(scale);
+            ScalePixel(XY(_width - 1, y), scale);
     }
 
     // give it a linear tail up and to the right
@@ -1073,17 +1305,17 @@ public:
         {
             for (int y = _height - 2; y >= 0; y--)
             {
-                leds[XY(x + 1, y)] += leds[XY(x, y + 1)];
-                leds[XY(x, y)].nscale8(scale);
+                AddPixel(XY(x + 1, y), XY(x, y + 1));
+                ScalePixel(XY(x, y), scale);
             }
         }
         // fade the bottom row
         for (int x = 0; x < _width; x++)
-            leds[XY(x, _height - 1)].nscale8(scale);
+            ScalePixel(XY(x, _height - 1), scale);
 
         // fade the right column
         for (int y = 0; y < _height; y++)
-            leds[XY(_width - 1, y)].nscale8(scale);
+            ScalePixel(XY(_width - 1, y), scale);
     }
 
     // just move everything one line down - BUGBUG (DAVEPL) Redundant with MoveX?
@@ -1177,13 +1409,13 @@ public:
         for (int i = 0; i < NUM_LEDS; i++)
         {
             // if ((leds[i].r != 255) || (leds[i].g != 255) || (leds[i].b != 255))           // Don't dim pure white
-            leds[i].nscale8(value);
+            ScalePixel(i, value);
         }
     }
 
     CRGB ColorFromCurrentPalette(uint8_t index = 0, uint8_t brightness = 255, TBlendType blendType = LINEARBLEND) const
     {
-        return ColorFromPalette(_currentPalette, index, brightness, _currentBlendType);
+        return _currentPaletteTable.Color(index, brightness);
     }
 
     static CRGB HsvToRgb(uint8_t h, uint8_t s, uint8_t v)
@@ -1304,4 +1536,10 @@ public:
     virtual void PrepareFrame() {}
 
     virtual void PostProcessFrame(uint16_t localPixelsDrawn, uint16_t wifiPixelsDrawn) {}
+
+    // Called by the draw loop to wait until the next frame is due; devices can use the time to refresh their output
+    virtual void WaitForNextFrame(int msDelay)
+    {
+        delay(msDelay);
+    }
 };
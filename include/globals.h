@@ -175,6 +175,8 @@
 #define DEBUG_PRIORITY          (tskIDLE_PRIORITY+2)
 #define JSONWRITER_PRIORITY     (tskIDLE_PRIORITY+2)
 #define COLORDATA_PRIORITY      (tskIDLE_PRIORITY+2)
+#define PREFETCH_PRIORITY       (tskIDLE_PRIORITY+2)
+#define HTTPFETCH_PRIORITY      (tskIDLE_PRIORITY+2)
 
 // If you experiment and mess these up, my go-to solution is to put Drawing on Core 0, and everything else on Core 1.
 // My current core layout is as follows, and as of today it's solid as of (7/16/21).
@@ -200,6 +202,8 @@
 #define REMOTE_CORE             1
 #define JSONWRITER_CORE         0
 #define COLORDATA_CORE          1
+#define PREFETCH_CORE           0           // Warms up the next effect on the core that isn't drawing
+#define HTTPFETCH_CORE          0
 
 #define FASTLED_INTERNAL            1   // Suppresses the compilation banner from FastLED
 #define __STDC_FORMAT_MACROS
@@ -1440,6 +1444,87 @@ extern RemoteDebug Debug;           // Let everyone in the project know about it
 #define TIME_BEFORE_LOCAL 5
 #endif
 
+// Effects take their working buffers from an arena of their own (see arena.h), which grows in blocks of this size
+// and is handed back in full when the effect is unloaded.
+
+#ifndef EFFECT_ARENA_BLOCK_SIZE
+  #ifdef USE_PSRAM
+    #define EFFECT_ARENA_BLOCK_SIZE (16 * 1024)
+  #else
+    #define EFFECT_ARENA_BLOCK_SIZE (4 * 1024)
+  #endif
+#endif
+
+// Effects are only instantiated when they're about to be played. With EFFECT_PREFETCH set, the effect that's
+// up next is unpacked, constructed and prepared (see LEDStripEffect::Prepare()) by a background task on
+// PREFETCH_CORE during the last EFFECT_PREFETCH_LEAD_TIME ms of the current effect, so the draw task doesn't
+// stall when the effects switch. Its Init() still runs on the draw task when it's started, as that may draw on
+// the devices.
+
+#ifndef EFFECT_PREFETCH
+  #if CONFIG_FREERTOS_UNICORE
+    #define EFFECT_PREFETCH 0
+  #else
+    #define EFFECT_PREFETCH 1
+  #endif
+#endif
+
+#ifndef EFFECT_PREFETCH_LEAD_TIME
+#define EFFECT_PREFETCH_LEAD_TIME 4000
+#endif
+
+// With GIF_FRAME_CACHE set, the animated GIF effects keep the frames of a GIF once it has been decoded in full,
+// and play it back from there from then on.  This takes up to a few hundred KB per GIF, so it's for PSRAM boards.
+// The GIFs played least recently are dropped from the cache when it grows beyond GIF_FRAME_CACHE_MAX_BYTES.
+
+#ifndef GIF_FRAME_CACHE
+  #ifdef USE_PSRAM
+    #define GIF_FRAME_CACHE 1
+  #else
+    #define GIF_FRAME_CACHE 0
+  #endif
+#endif
+
+#ifndef GIF_FRAME_CACHE_MAX_BYTES
+#define GIF_FRAME_CACHE_MAX_BYTES (512 * 1024)
+#endif
+
+// Effects that pull data from the web queue their requests with the HTTPFetcher, which runs them on
+// HTTP_FETCH_WORKERS tasks of its own.  The timeouts (in ms) bound how long a dead server can tie up a worker.
+
+#ifndef HTTP_FETCH_WORKERS
+#define HTTP_FETCH_WORKERS 2
+#endif
+
+#ifndef HTTP_FETCH_CONNECT_TIMEOUT
+#define HTTP_FETCH_CONNECT_TIMEOUT 3000
+#endif
+
+#ifndef HTTP_FETCH_TIMEOUT
+#define HTTP_FETCH_TIMEOUT 5000
+#endif
+
+// Network reader scheduling, all in ms.  A reader that runs longer than its budget (NETWORK_READER_BUDGET_MS unless
+// it asks for another) gets a warning in the log.  The network task stops starting readers for a while once it has
+// spent NETWORK_READER_CYCLE_BUDGET_MS on them.  Readers that fail are retried after NETWORK_READER_RETRY_MS, which
+// doubles with every failure in a row up to NETWORK_READER_MAX_BACKOFF_MS.
+
+#ifndef NETWORK_READER_BUDGET_MS
+#define NETWORK_READER_BUDGET_MS 1000
+#endif
+
+#ifndef NETWORK_READER_CYCLE_BUDGET_MS
+#define NETWORK_READER_CYCLE_BUDGET_MS 250
+#endif
+
+#ifndef NETWORK_READER_RETRY_MS
+#define NETWORK_READER_RETRY_MS 5000
+#endif
+
+#ifndef NETWORK_READER_MAX_BACKOFF_MS
+#define NETWORK_READER_MAX_BACKOFF_MS (5 * 60 * 1000)
+#endif
+
 #ifndef ENABLE_REMOTE
 #define ENABLE_REMOTE 0
 #endif
@@ -1456,6 +1541,18 @@ extern RemoteDebug Debug;           // Let everyone in the project know about it
 #define MATRIX_CALC_DIVIDER 3
 #endif
 
+// With TRACK_DIRTY_REGIONS, every frame is compared to the one before to find the rectangle that changed. The matrix
+// then skips or shortens its buffer swaps, and the color data server skips frames that didn't change. This costs a
+// copy of the frame (from PSRAM when there is any).
+
+#ifndef TRACK_DIRTY_REGIONS
+  #if USE_HUB75
+    #define TRACK_DIRTY_REGIONS 1
+  #else
+    #define TRACK_DIRTY_REGIONS 0
+  #endif
+#endif
+
 // Power Limit
 //
 // The maximum amount of power, in milliwatts, that you want your project to use, if you want to limit that.
@@ -1469,6 +1566,39 @@ extern RemoteDebug Debug;           // Let everyone in the project know about it
 // #define POWER_LIMIT_MW 500*5                 // Define for your power draw limit. Example is a low 2500mA
                                                 // which may dim your LEDs quite a lot.
 
+// Output stage for LED strips (see outputlut.h). An OUTPUT_GAMMA of 1.0 sends colors out linearly, like FastLED
+// does by default; OUTPUT_WHITE_BALANCE scales the red, green and blue channels like FastLED's setCorrection().
+
+#ifndef OUTPUT_GAMMA
+#define OUTPUT_GAMMA 1.0f
+#endif
+
+#ifndef OUTPUT_WHITE_BALANCE
+#define OUTPUT_WHITE_BALANCE 0xFFFFFF
+#endif
+
+// With OUTPUT_DITHER, the strip output stage dithers over time so that low brightness levels don't band. While the
+// draw loop waits for the next effect frame, the last frame is sent again (with new dithering) up to
+// OUTPUT_REFRESH_RATE times per second, so the dithering isn't limited to the effect's frame rate. That costs an
+// extra buffer per channel and a lot more time spent sending to the strip, so it's off unless a project turns
+// it on in its section above.
+
+#ifndef OUTPUT_DITHER
+#define OUTPUT_DITHER 0
+#endif
+
+#ifndef OUTPUT_REFRESH_RATE
+#define OUTPUT_REFRESH_RATE 120
+#endif
+
+// With HIGH_PRECISION_FRAMEBUFFER, every device keeps 8 extra bits per color channel below those in its leds
+// buffer, which the GFXBase fading and streaming helpers use so long trails decay smoothly. It costs three bytes
+// per pixel (taken from PSRAM when there is any), and the strip output stage uses the extra bits when dithering.
+
+#ifndef HIGH_PRECISION_FRAMEBUFFER
+#define HIGH_PRECISION_FRAMEBUFFER 0
+#endif
+
 // Display
 //
 // Enable USE_OLED or USE_TFT based on selected board definition
@@ -1893,6 +2023,7 @@ constexpr std::array<T, N> to_array(const T (&arr)[N]) {
 
 // Main includes
 
+#include "arena.h"                              // Scratch memory arenas for effects
 #include "gfxbase.h"                            // GFXBase drawing interface
 #include "socketserver.h"                       // Incoming WiFi data connections
 #include "ledstripgfx.h"                        // Essential drawing code for strips
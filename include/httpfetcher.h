@@ -0,0 +1,177 @@
+//+--------------------------------------------------------------------------
+//
+// File:        httpfetcher.h
+//
+// NightDriverStrip - (c) 2026 Plummer's Software LLC.  All Rights Reserved.
+//
+// This file is part of the NightDriver software project.
+//
+//    NightDriver is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    NightDriver is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with Nightdriver.  It is normally found in copying.txt
+//    If not, see <https://www.gnu.org/licenses/>.
+//
+// Description:
+//
+//    Asynchronous HTTP GET service for effects that show data from the web.
+//    Requests are queued and executed by a small pool of worker tasks, each
+//    of which keeps its own HTTPClient (and with it, a kept-alive connection)
+//    around.  Results are delivered to a callback on the worker task, and
+//    successful responses can be cached for a while so that effects that
+//    are started again shortly after don't have to fetch everything anew.
+//
+//    This keeps slow or unresponsive servers from blocking the network
+//    task, which also handles WiFi reconnects and the other readers.
+//
+//    JSON can be parsed straight off the connection with a filter, so that
+//    only the fields an effect actually uses are ever held in memory; the
+//    web APIs we talk to tend to send many KB of data we have no use for.
+//
+//---------------------------------------------------------------------------
+
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <HTTPClient.h>
+
+#include "globals.h"
+
+// HTTPResponse
+//
+// What a fetch resulted in. The status code is either the HTTP status the server replied with, or one of
+// HTTPClient's (negative) HTTPC_ERROR_ codes if the request didn't get that far. For JSON fetches, the body
+// is left empty and jsonError tells if the document could be parsed.
+
+struct HTTPResponse
+{
+    int    statusCode = 0;
+    String body;
+    DeserializationError jsonError;
+    bool   fromCache  = false;
+
+    bool IsOK() const
+    {
+        return statusCode == HTTP_CODE_OK && !jsonError;
+    }
+
+    String ErrorString() const
+    {
+        if (jsonError)
+            return jsonError.c_str();
+
+        return statusCode < 0 ? HTTPClient::errorToString(statusCode) : String(statusCode);
+    }
+};
+
+// HTTPFetcher
+//
+// Queues GET requests for its worker tasks, which are only started when the first request that isn't served from
+// the cache comes in; builds without effects that use the web don't pay for their stacks. Callbacks are invoked one at a time, so they don't need to guard against each other, and they may queue follow-up fetches.
+// Objects that issue fetches with themselves as owner must call CancelFetches() before they go away.
+
+class HTTPFetcher
+{
+  public:
+
+    using Callback = std::function<void(const HTTPResponse&)>;
+    using JSONCallback = std::function<void(const HTTPResponse&, JsonDocument&)>;
+
+  private:
+
+    struct Request
+    {
+        String        url;
+        Callback      callback;
+        JSONCallback  jsonCallback;
+        std::shared_ptr<JsonDocument> pFilter;                  // Only set for JSON fetches
+        const void *  owner;
+        unsigned long maxAgeMs;
+        bool          canceled = false;
+    };
+
+    // JSON fetches are cached as the filtered document, packed as MessagePack
+
+    struct CachedResponse
+    {
+        HTTPResponse  response;
+        std::vector<uint8_t> packedDocument;
+        bool          isJSON;
+        unsigned long fetchedMs;
+    };
+
+    static constexpr size_t kMaxCacheEntries = 16;              // The whole cache is emptied when it gets this full
+
+    std::mutex                  _queueMutex;                    // Guards the queue, the active list and the cache
+    std::recursive_mutex        _callbackMutex;                 // Held while a callback runs
+    SemaphoreHandle_t           _requestsAvailable;
+    std::deque<std::shared_ptr<Request>>  _queue;
+    std::vector<std::shared_ptr<Request>> _active;              // Requests that a worker is executing right now
+    std::map<String, CachedResponse>      _cache;
+    std::once_flag              _workersStarted;
+
+    std::atomic_size_t          _fetches    = 0;
+    std::atomic_size_t          _cacheHits  = 0;
+    std::atomic_size_t          _failures   = 0;
+
+    bool GetCached(const Request& request, HTTPResponse& response, std::vector<uint8_t>& packedDocument);
+    void Queue(std::shared_ptr<Request> pRequest);
+    void Execute(HTTPClient& http, Request& request);
+    void Complete(Request& request, const HTTPResponse& response, JsonDocument& document);
+
+  public:
+
+    HTTPFetcher();
+    ~HTTPFetcher();
+
+    // Queues a GET request for url. If maxAgeMs is non-zero, a successful response is cached and reused for
+    // requests within that many ms, in which case the callback is invoked right away on the calling task.
+    void Fetch(const String& url, Callback callback, const void * owner = nullptr, unsigned long maxAgeMs = 0);
+
+    // Like Fetch(), but parses the response as JSON while it comes in, keeping only what the filter selects (see
+    // ArduinoJson's DeserializationOption::Filter). Fetches of the same URL are expected to use the same filter.
+    void FetchJSON(const String& url, const JsonDocument& filter, JSONCallback callback, const void * owner = nullptr, unsigned long maxAgeMs = 0);
+
+    // Drops queued requests for owner and makes sure none of its callbacks are running or will run
+    void CancelFetches(const void * owner);
+
+    // Executes requests as they come in; this is what the worker tasks run
+    void WorkerLoop();
+
+    size_t QueueLength()
+    {
+        std::lock_guard<std::mutex> guard(_queueMutex);
+        return _queue.size();
+    }
+
+    size_t Fetches() const
+    {
+        return _fetches;
+    }
+
+    size_t CacheHits() const
+    {
+        return _cacheHits;
+    }
+
+    size_t Failures() const
+    {
+        return _failures;
+    }
+};
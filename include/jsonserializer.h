@@ -169,7 +169,17 @@ bool LoadJSONFile(const String & fileName, JsonDocument& jsonDoc);
 bool SaveToJSONFile(const String & fileName, IJSONSerializable& object);
 bool RemoveJSONFile(const String & fileName);
 
-#define JSON_WRITER_DELAY 3000
+// Replaces the contents of a file by writing them to a temporary file first and then renaming that, so a power cut
+//   never leaves a half-written file behind. Writes of contents identical to what was last read or written are skipped.
+bool ReplaceFileContents(const String & fileName, const uint8_t * pData, size_t length);
+
+// Finishes a replacement by ReplaceFileContents() that was interrupted between removing the old file and renaming the
+//   temporary one. Anything that reads a file written by ReplaceFileContents() should call this before opening it.
+void RecoverReplacedFile(const String & fileName);
+
+#define JSON_WRITER_DELAY           3000    // Time to wait after the latest flag before writing
+#define JSON_WRITER_MAX_DELAY       30000   // Longest time newer flags can postpone a pending write
+#define JSON_WRITER_MIN_INTERVAL    10000   // Shortest time between two batches of writes, unless flushed
 
 class JSONWriter
 {
@@ -194,9 +204,27 @@ class JSONWriter
 
     std::vector<WriterEntry, psram_allocator<WriterEntry>> writers;
     std::atomic_ulong        latestFlagMs;
+    std::atomic_ulong        pendingSinceMs = 0;    // When the oldest flag that hasn't been written yet was raised
+    std::atomic_ulong        latestCommitMs = 0;
     std::atomic_bool         flushRequested;
     std::atomic_bool         haltWrites;
 
+  public:
+
+    // Counters that show how much we actually write to flash
+    struct Statistics
+    {
+        std::atomic_size_t   flagsRaised    = 0;    // Calls to FlagWriter()
+        std::atomic_size_t   commits        = 0;    // Batches of writes
+        std::atomic_size_t   filesWritten   = 0;
+        std::atomic_size_t   filesUnchanged = 0;    // Writes skipped because the contents didn't change
+        std::atomic_size_t   bytesWritten   = 0;
+    };
+
+  private:
+
+    Statistics               statistics;
+
   public:
 
     // Add a writer to the collection. Returns the index of the added writer, for use with FlagWriter()
@@ -207,5 +235,22 @@ class JSONWriter
 
     // Flush pending writes now
     void FlushWrites(bool halt = false);
+
+    const Statistics& GetStatistics() const
+    {
+        return statistics;
+    }
+
+    // Called by the functions that write to flash, to keep the statistics
+    void CountFileWrite(size_t bytes)
+    {
+        statistics.filesWritten++;
+        statistics.bytesWritten += bytes;
+    }
+
+    void CountUnchangedFile()
+    {
+        statistics.filesUnchanged++;
+    }
 };
 
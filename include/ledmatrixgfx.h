@@ -35,6 +35,7 @@
 #if USE_HUB75
 
 #include <SmartMatrix.h>
+#include "powerlimiter.h"
 
 //
 // Matrix Panel
@@ -98,8 +99,8 @@ public:
 
     // EstimatePowerDraw
     //
-    // Estimate the total power load for the board and matrix by walking the pixels and adding our previously measured
-    // power draw per pixel based on what color and brightness each pixel is
+    // Estimate the total power load for the board and matrix by totalling the color channels of all pixels and applying
+    // our previously measured power draw per channel to those totals
 
     int EstimatePowerDraw()
     {
@@ -108,15 +109,10 @@ public:
         constexpr auto mwPerPixelGreen = 0.82f;
         constexpr auto mwPerPixelBlue  = 1.75f;
 
-        float totalPower = kBaseLoad;
-        for (int i = 0; i < NUM_LEDS; i++)
-        {
-            const auto pixel = leds[i];
-            totalPower += pixel.r * mwPerPixelRed   / 255.0f;
-            totalPower += pixel.g * mwPerPixelGreen / 255.0f;
-            totalPower += pixel.b * mwPerPixelBlue  / 255.0f;
-        }
-        return (int) totalPower;
+        ColorSums sums;
+        sums.Add(leds, NUM_LEDS);
+
+        return kBaseLoad + sums.Milliwatts(mwPerPixelRed, mwPerPixelGreen, mwPerPixelBlue);
     }
 
     uint16_t xy(uint16_t x, uint16_t y) const override
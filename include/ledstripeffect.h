@@ -31,6 +31,8 @@
 #pragma once
 
 #include "effects.h"
+#include "arena.h"
+#include "effectsources.h"
 #include "gfxbase.h"
 #include "jsonserializer.h"
 #include "ledmatrixgfx.h"
@@ -87,6 +89,11 @@ class LEDStripEffect : public IJSONSerializable
 
     bool   _coreEffect = false;
 
+    std::shared_ptr<EffectSources> _sources;    // Where the time helpers below get their time from; live if not set
+
+    ScratchArena _arena         { ArenaMemory::PreferPSRAM };       // See Arena() below
+    ScratchArena _internalArena { ArenaMemory::PreferInternal };
+
     // This "lazy loads" the SettingSpec instances for LEDStripEffect. Note that it adds the actual
     // instances to a static vector, meaning they are loaded once for all effects. The _settingSpecReferences
     // instance variable vector only contains reference_wrappers to the actual SettingSpecs to save
@@ -136,6 +143,49 @@ class LEDStripEffect : public IJSONSerializable
 
     std::vector<std::shared_ptr<GFXBase>> _GFX;
 
+    // Time helpers. Effects that use these instead of millis() and g_Values.AppTime can be replayed with a fixed
+    //   clock (see effectsources.h), which makes their output reproducible frame for frame.
+
+    const EffectSources & Sources() const
+    {
+        return _sources ? *_sources : EffectSources::Live();
+    }
+
+    unsigned long Millis() const
+    {
+        return Sources().Millis();
+    }
+
+    double AppTime() const
+    {
+        return Sources().AppTime();
+    }
+
+    double FrameTime() const
+    {
+        return Sources().FrameTime();
+    }
+
+    // Memory for the buffers an effect sets up in Init().  It's only allocated when asked for, and goes back to the
+    //   heap in one piece when the effect is unloaded, so the buffers needn't (and can't) be freed one by one.
+    //   Buffers that are read and written many times per frame can ask for internal RAM instead of PSRAM.
+    ScratchArena & Arena(ArenaMemory memory = ArenaMemory::PreferPSRAM)
+    {
+        return memory == ArenaMemory::PreferInternal ? _internalArena : _arena;
+    }
+
+    // Like FastLED's EVERY_N_MILLISECONDS, but going by Millis() and with the time of the last trigger kept by the
+    //   caller, so that it works per effect instance and replays like the rest of the effect's timing
+    bool IsIntervalDue(unsigned long& lastMs, unsigned long interval) const
+    {
+        unsigned long now = Millis();
+        if (now - lastMs < interval)
+            return false;
+
+        lastMs = now;
+        return true;
+    }
+
     // Macro that assigns a value to a property if two names match
     #define SET_IF_NAMES_MATCH(firstName, secondName, property, value)  if (firstName == secondName) \
     { \
@@ -240,6 +290,15 @@ class LEDStripEffect : public IJSONSerializable
     virtual ~LEDStripEffect()
     = default;
 
+    // Optional hook for the part of setting up an effect that doesn't need the devices, like allocating its buffers
+    //   from Arena(). When the effect is prefetched, this is called on the prefetch task before the effect is handed
+    //   to the draw task, so the allocations don't hold up a frame. Init() must work whether or not it was called,
+    //   so effects that implement it usually call it from Init() as well, and make it do nothing the second time.
+    virtual bool Prepare()
+    {
+        return true;
+    }
+
     virtual bool Init(std::vector<std::shared_ptr<GFXBase>>& gfx)
     {
         debugV("Init %s", _friendlyName.c_str());
@@ -253,6 +312,12 @@ class LEDStripEffect : public IJSONSerializable
         return true;
     }
 
+    // Replaces the sources the time helpers use; pass nullptr to go back to the live clock
+    void SetSources(std::shared_ptr<EffectSources> sources)
+    {
+        _sources = std::move(sources);
+    }
+
     virtual void Start() {}                                         // Optional method called when time to clean/init the effect
     virtual void Draw() = 0;                                        // Your effect must implement these
 
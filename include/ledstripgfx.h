@@ -32,6 +32,7 @@
 
 #pragma once
 #include "gfxbase.h"
+#include "outputlut.h"
 
 // LEDStripGFX
 //
@@ -40,6 +41,13 @@
 class LEDStripGFX : public GFXBase
 {
 protected:
+    CRGB * _outputLeds = nullptr;                               // What FastLED sends: leds after the output stage
+    CRGB * _ditherError = nullptr;                              // Per-pixel fractions carried to the next output pass
+
+    // Sends the first 'count' pixels of every channel through the output stage to the LEDs. Refreshes resend
+    // the last frame, and are kept out of the FPS count.
+    static void ShowOutput(uint16_t count, ColorSums * pSums, bool bRefresh = false);
+
     static void AddLEDsToFastLED(std::vector<std::shared_ptr<GFXBase>>& devices)
     {
         // Macro to add LEDs to a channel
@@ -93,9 +101,8 @@ protected:
             ADD_CHANNEL(7);
         #endif
 
-        #ifdef POWER_LIMIT_MW
-            set_max_power_in_milliwatts(POWER_LIMIT_MW);                // Set brightness limit
-        #endif
+        // Note that POWER_LIMIT_MW is not passed on to FastLED, because the power limit is applied by our
+        // own output stage in PostProcessFrame()
     }
 
 public:
@@ -106,12 +113,59 @@ public:
         leds = static_cast<CRGB *>(calloc(w * h, sizeof(CRGB)));
         if(!leds)
             throw std::runtime_error("Unable to allocate LEDs in LEDStripGFX");
+
+        #if OUTPUT_DITHER
+            _ditherError = static_cast<CRGB *>(calloc(w * h, sizeof(CRGB)));
+            if (!_ditherError)
+                throw std::runtime_error("Unable to allocate dither buffer in LEDStripGFX");
+        #endif
     }
 
     ~LEDStripGFX() override
     {
         free(leds);
         leds = nullptr;
+        free(_outputLeds);
+        _outputLeds = nullptr;
+        free(_ditherError);
+        _ditherError = nullptr;
+    }
+
+    // ApplyOutputStage
+    //
+    // Runs the first 'count' pixels through the output tables and returns the buffer FastLED should send. The
+    // result goes to a separate buffer so that effects which build on their previous frame never see it; that
+    // buffer isn't allocated until the tables first have something to do. The colors as drawn are added to pSums
+    // if given, so that power accounting doesn't need a pass of its own.
+
+    CRGB * ApplyOutputStage(const OutputLUT& outputLUT, size_t count, ColorSums * pSums)
+    {
+        // Identity tables have nothing to do, unless there are framebuffer fractions that can be dithered in
+        if (outputLUT.IsIdentity() && !(_ditherError && GetLedFractions()))
+        {
+            if (pSums)
+                pSums->Add(leds, count);
+            return leds;
+        }
+
+        if (!_outputLeds)
+        {
+            _outputLeds = static_cast<CRGB *>(calloc(_width * _height, sizeof(CRGB)));
+            if (!_outputLeds)
+            {
+                debugW("No memory for the output buffer, sending colors as drawn");
+                if (pSums)
+                    pSums->Add(leds, count);
+                return leds;
+            }
+        }
+
+        if (_ditherError)
+            outputLUT.ApplyDithered(leds, GetLedFractions(), _ditherError, _outputLeds, count, pSums);
+        else
+            outputLUT.Apply(leds, _outputLeds, count, pSums);
+
+        return _outputLeds;
     }
 
     static void InitializeHardware(std::vector<std::shared_ptr<GFXBase>>& devices)
@@ -136,6 +190,12 @@ public:
     // PostProcessFrame sends the data to the LED strip.  If it's fewer than the size of the strip, we only send that many.
 
     void PostProcessFrame(uint16_t localPixelsDrawn, uint16_t wifiPixelsDrawn) override;
+
+    // WaitForNextFrame
+    //
+    // With dithering enabled, this keeps refreshing the strip with the last frame while we wait for the next one.
+
+    void WaitForNextFrame(int msDelay) override;
 };
 
 #if HEXAGON
@@ -27,6 +27,8 @@
 //---------------------------------------------------------------------------
 #pragma once
 
+#include <memory>
+#include <mutex>
 #include <utility>
 
 #include "types.h"
@@ -59,7 +61,7 @@
 
     WiFiConnectResult ConnectToWiFi(const String& ssid, const String& password);
     WiFiConnectResult ConnectToWiFi(const String* ssid, const String* password);
-    void UpdateNTPTime();
+    bool UpdateNTPTime();
     void SetupOTA(const String & strHostname);
     bool ReadWiFiConfig(String& WiFi_ssid, String& WiFi_password);
     bool WriteWiFiConfig(const String& WiFi_ssid, const String& WiFi_password);
@@ -124,60 +126,125 @@
       return str_sprintf("%02X:%02X:%02X:%02X:%02X:%02X", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
     }
 
+    // ReaderPriority
+    //
+    // When several readers are due at the same time, the ones with higher priority run first. High is for readers
+    // that fetch what an effect is showing right now (weather, stocks), Low for background work that can wait (the
+    // clock, subscriber counts).
+
+    enum class ReaderPriority
+    {
+      Low,
+      Normal,
+      High
+    };
+
+    // ReaderOptions
+    //
+    // How a reader is to be scheduled, beyond its interval. Readers that may block for a long time (like the NTP
+    // client, which waits for a UDP reply) can get a task of their own, so they don't hold up the network task.
+    // Such readers are meant to stay registered for as long as the system runs.
+
+    struct ReaderOptions
+    {
+      const char *   name      = "Reader";
+      ReaderPriority priority  = ReaderPriority::Normal;
+      unsigned long  budgetMs  = NETWORK_READER_BUDGET_MS;    // Runs that take longer are logged and counted; 0 for none
+      bool           ownTask   = false;
+    };
+
+    // ReaderStats
+    //
+    // Execution time statistics for a reader
+
+    struct ReaderStats
+    {
+      size_t        runs      = 0;
+      size_t        failures  = 0;
+      size_t        overruns  = 0;                      // Number of runs that went over the reader's budget
+      unsigned long lastUs    = 0;
+      unsigned long maxUs     = 0;
+      uint64_t      totalUs   = 0;
+
+      unsigned long AverageUs() const
+      {
+          return runs ? totalUs / runs : 0;
+      }
+    };
+
     // NetworkReader
     //
     // Allows functions to be registered that are called at regular intervals and/or on request, in the
     // background. As the name of the class implies, this is intended to be used to execute network
     // requests, like for effects that require data from RESTful APIs.
+    //
+    // The network task asks RunDueReaders() to run whatever readers are due, highest priority first and
+    // then earliest deadline first. It stops starting new readers once NETWORK_READER_CYCLE_BUDGET_MS has
+    // passed, so that the network task gets back to its own housekeeping in between. Readers registered
+    // with RegisterReaderWithRetry() report failure by returning false, after which they are retried with
+    // an exponentially growing delay.
 
     class NetworkReader
     {
-      // We allow the main network task entry point function to access private members
-      friend void IRAM_ATTR NetworkHandlingLoopEntry(void *);
-
     private:
 
-      // Writer function and flag combo
       struct ReaderEntry
       {
-          std::function<void()> reader;
+          std::function<bool()> reader;
+          ReaderOptions options;
           std::atomic_ulong readInterval;
           std::atomic_ulong lastReadMs;
           std::atomic_bool flag = false;
           std::atomic_bool canceled = false;
+          std::atomic_bool running = false;             // Set while the reader is queued for or running on its own task
+          TaskHandle_t task = nullptr;
+          std::mutex runMutex;                          // Held while the reader runs, so it can't be canceled halfway
 
-          ReaderEntry(std::function<void()> reader, unsigned long interval) :
-              reader(std::move(reader)),
-              lastReadMs(0),
-              readInterval(interval)
-          {}
+          // Only touched while runMutex is held
+          size_t consecutiveFailures = 0;
+          std::atomic_ulong retryAtMs;
+          ReaderStats stats;
 
-          ReaderEntry(std::function<void()> reader, unsigned long interval, unsigned long lastReadMs, bool flag, bool canceled) :
+          ReaderEntry(std::function<bool()> reader, unsigned long interval, const ReaderOptions& options) :
               reader(std::move(reader)),
+              options(options),
               readInterval(interval),
-              lastReadMs(lastReadMs),
-              flag(flag),
-              canceled(canceled)
-          {}
-
-          ReaderEntry(ReaderEntry&& entry)  noexcept : ReaderEntry(entry.reader, entry.readInterval, entry.lastReadMs, entry.flag, entry.canceled)
+              lastReadMs(0),
+              retryAtMs(0)
           {}
       };
 
-      std::vector<ReaderEntry, psram_allocator<ReaderEntry>> readers;
+      // Entries are held by pointer, so they stay put when readers are added while others run
+      std::vector<std::unique_ptr<ReaderEntry>> readers;
+      mutable std::mutex readersMutex;
+
+      size_t AddReader(std::function<bool()> reader, unsigned long interval, bool flag, const ReaderOptions& options);
+      ReaderEntry * GetEntry(size_t index) const;
+      void Run(ReaderEntry& entry);
+
+      static void ReaderTaskEntry(void * pvEntry);
 
     public:
 
       // Add a reader to the collection. Returns the index of the added reader, for use with FlagReader().
       //   Note that if an interval (in ms) is specified, the reader will run for the first time after
-      //   the interval has passed, unless "true" is passed to the last parameter.
-      size_t RegisterReader(const std::function<void()>& reader, unsigned long interval = 0, bool flag = false);
+      //   the interval has passed, unless "true" is passed to the flag parameter.
+      size_t RegisterReader(const std::function<void()>& reader, unsigned long interval = 0, bool flag = false, const ReaderOptions& options = {});
+
+      // Like RegisterReader(), for a reader that returns false when it fails and should then be retried with backoff
+      size_t RegisterReaderWithRetry(const std::function<bool()>& reader, unsigned long interval = 0, bool flag = false, const ReaderOptions& options = {});
 
       // Flag a reader for invocation and wake up the task that calls them
       void FlagReader(size_t index);
 
       // Cancel a reader. After this, it will no longer be invoked.
       void CancelReader(size_t index);
+
+      // Runs the readers that are due, and returns how many ms the network task can sleep until the next one is
+      unsigned long RunDueReaders();
+
+      // Writes the execution statistics of all readers to the debug log
+      void LogStatistics() const;
   };
 
 #endif
@@ -0,0 +1,163 @@
+//+--------------------------------------------------------------------------
+//
+// File:        outputlut.h
+//
+// NightDriverStrip - (c) 2026 Plummer's Software LLC.  All Rights Reserved.
+//
+// This file is part of the NightDriver software project.
+//
+//    NightDriver is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    NightDriver is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with Nightdriver.  It is normally found in copying.txt
+//    If not, see <https://www.gnu.org/licenses/>.
+//
+// Description:
+//
+//    The output stage for LED strips.  Gamma, white balance and the final
+//    (brightness x fader x power limit) scale are folded into one lookup
+//    table per color channel, so that a frame goes through all of them in
+//    a single pass on its way to FastLED.  The tables are only rebuilt when
+//    the brightness changes; gamma and white balance are fixed at compile
+//    time through OUTPUT_GAMMA and OUTPUT_WHITE_BALANCE.
+//
+//    The tables hold 8.8 fixed point values, so the part of a color that
+//    falls between two output levels isn't lost.  With OUTPUT_DITHER set
+//    that fraction is carried over per pixel to the next time the pixel is
+//    sent, which makes low brightness levels average out to the right value
+//    instead of collapsing into a few visible steps.  The fractions of a
+//    high precision framebuffer are taken into account by interpolating
+//    between table entries.
+//
+//---------------------------------------------------------------------------
+
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <FastLED.h>
+
+#include "powerlimiter.h"
+
+// OutputLUT
+//
+// Per-channel tables mapping a drawn color value to the value that is sent to the LEDs, times 256.
+
+class OutputLUT
+{
+    std::array<uint16_t, 256> _red;
+    std::array<uint16_t, 256> _green;
+    std::array<uint16_t, 256> _blue;
+
+    uint8_t _brightness = 0;
+    bool    _identity   = false;
+    bool    _valid      = false;
+
+    static void BuildChannel(std::array<uint16_t, 256>& table, uint8_t balance, uint8_t brightness)
+    {
+        const float scale = balance / 255.0f * brightness / 255.0f;
+
+        // The largest value is 255 * 256, which leaves room for adding a dither fraction of up to 255
+        for (int i = 0; i < 256; i++)
+            table[i] = (uint16_t) lroundf(powf(i / 255.0f, OUTPUT_GAMMA) * scale * 255.0f * 256.0f);
+    }
+
+    // Table value for a channel value plus a fraction (in 256ths) of the step to the next one. Fractions of a zero
+    // value are ignored: an effect may have set the pixel to black without clearing its stale fraction, and
+    // interpolating that would make it flicker at the lowest level.
+    static uint16_t Lookup(const std::array<uint16_t, 256>& table, uint8_t value, uint8_t fraction)
+    {
+        if (fraction == 0 || value == 0 || value == 255)
+            return table[value];
+
+        return table[value] + (((uint32_t) (table[value + 1] - table[value]) * fraction) >> 8);
+    }
+
+    static uint8_t Round(uint16_t value)
+    {
+        return (value + 128) >> 8;
+    }
+
+    // Adds the fraction left over from the last time, and keeps the new fraction for the next
+    static uint8_t Dither(uint16_t value, uint8_t& error)
+    {
+        const uint16_t total = value + error;
+        error = total & 0xFF;
+        return total >> 8;
+    }
+
+  public:
+
+    // Rebuilds the tables if the brightness differs from the one they were built for
+    void Update(uint8_t brightness)
+    {
+        if (_valid && brightness == _brightness)
+            return;
+
+        const CRGB balance(OUTPUT_WHITE_BALANCE);
+
+        BuildChannel(_red,   balance.r, brightness);
+        BuildChannel(_green, balance.g, brightness);
+        BuildChannel(_blue,  balance.b, brightness);
+
+        _brightness = brightness;
+        _identity = brightness == 255 && balance == CRGB(CRGB::White) && OUTPUT_GAMMA == 1.0f;
+        _valid = true;
+    }
+
+    // True if the tables map every value to itself, in which case the pass can be skipped altogether
+    bool IsIdentity() const
+    {
+        return _identity;
+    }
+
+    // Maps count pixels from pSource into pDest, adding the source colors to pSums (if given) on the way for
+    // power accounting
+    void Apply(const CRGB * pSource, CRGB * pDest, size_t count, ColorSums * pSums = nullptr) const
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            const CRGB color = pSource[i];
+            if (pSums)
+                pSums->Add(color);
+
+            pDest[i].r = Round(_red[color.r]);
+            pDest[i].g = Round(_green[color.g]);
+            pDest[i].b = Round(_blue[color.b]);
+        }
+    }
+
+    // Like Apply(), but dithers using the per-pixel fractions in pError, which are updated for the next pass. If
+    // pFractions is given, it holds the low 8 bits of the source colors.
+    void ApplyDithered(const CRGB * pSource, const CRGB * pFractions, CRGB * pError, CRGB * pDest, size_t count, ColorSums * pSums = nullptr) const
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            const CRGB color = pSource[i];
+            if (pSums)
+                pSums->Add(color);
+
+            if (pFractions)
+            {
+                const CRGB fraction = pFractions[i];
+                pDest[i].r = Dither(Lookup(_red,   color.r, fraction.r), pError[i].r);
+                pDest[i].g = Dither(Lookup(_green, color.g, fraction.g), pError[i].g);
+                pDest[i].b = Dither(Lookup(_blue,  color.b, fraction.b), pError[i].b);
+            }
+            else
+            {
+                pDest[i].r = Dither(_red[color.r],   pError[i].r);
+                pDest[i].g = Dither(_green[color.g], pError[i].g);
+                pDest[i].b = Dither(_blue[color.b],  pError[i].b);
+            }
+        }
+    }
+};
@@ -0,0 +1,92 @@
+//+--------------------------------------------------------------------------
+//
+// File:        palettetable.h
+//
+// NightDriverStrip - (c) 2026 Plummer's Software LLC.  All Rights Reserved.
+//
+// This file is part of the NightDriver software project.
+//
+//    NightDriver is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    NightDriver is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with Nightdriver.  It is normally found in copying.txt
+//    If not, see <https://www.gnu.org/licenses/>.
+//
+// Description:
+//
+//    A 16-entry palette expanded into all 256 colors ColorFromPalette()
+//    can return for it.  Looking a color up is then a plain array index
+//    instead of the interpolation ColorFromPalette() does on every call,
+//    which adds up for effects that pick a palette color for every pixel.
+//
+//---------------------------------------------------------------------------
+
+#pragma once
+
+#include <FastLED.h>
+
+// PaletteTable
+//
+// Holds the expansion of one palette. Update() only re-expands when the palette or blend type differ from
+// what the table was last built from, so it's cheap to call every frame while a palette is crossfading.
+
+class PaletteTable
+{
+    CRGB          _entries[256];
+    CRGBPalette16 _source;
+    TBlendType    _blendType = LINEARBLEND;
+    bool          _valid     = false;
+
+  public:
+
+    PaletteTable() = default;
+
+    explicit PaletteTable(const CRGBPalette16& palette, TBlendType blendType = LINEARBLEND)
+    {
+        Update(palette, blendType);
+    }
+
+    // Expands the palette if it isn't what the table holds already; returns true if the table was rebuilt
+    bool Update(const CRGBPalette16& palette, TBlendType blendType = LINEARBLEND)
+    {
+        if (_valid && _blendType == blendType && _source == palette)
+            return false;
+
+        for (int i = 0; i < 256; i++)
+            _entries[i] = ColorFromPalette(palette, i, 255, blendType);
+
+        _source = palette;
+        _blendType = blendType;
+        _valid = true;
+
+        return true;
+    }
+
+    const CRGB& operator[](uint8_t index) const
+    {
+        return _entries[index];
+    }
+
+    // Same result as ColorFromPalette(palette, index, brightness, blendType) for the palette the table holds
+    CRGB Color(uint8_t index, uint8_t brightness = 255) const
+    {
+        if (brightness == 255)
+            return _entries[index];
+
+        if (brightness == 0)
+            return CRGB::Black;
+
+        // ColorFromPalette bumps the brightness by one before scaling to compensate for rounding down
+        CRGB color = _entries[index];
+        color.nscale8(brightness + 1);
+        return color;
+    }
+};
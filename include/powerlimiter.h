@@ -0,0 +1,111 @@
+//+--------------------------------------------------------------------------
+//
+// File:        powerlimiter.h
+//
+// NightDriverStrip - (c) 2026 Plummer's Software LLC.  All Rights Reserved.
+//
+// This file is part of the NightDriver software project.
+//
+//    NightDriver is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    NightDriver is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with Nightdriver.  It is normally found in copying.txt
+//    If not, see <https://www.gnu.org/licenses/>.
+//
+// Description:
+//
+//    Power accounting for the LED output.  ColorSums collects the color
+//    totals of a frame, preferably while some other pass is touching every
+//    pixel anyway, and PowerLimiter turns the power the last frames drew
+//    into the brightness for the next one.
+//
+//---------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <FastLED.h>
+
+// ColorSums
+//
+// The totals of the red, green and blue values of a number of pixels. With 32 bits per channel this can't
+// overflow for anything less than 16 million pixels.
+
+struct ColorSums
+{
+    uint32_t red    = 0;
+    uint32_t green  = 0;
+    uint32_t blue   = 0;
+    uint32_t pixels = 0;
+
+    void Add(const CRGB& color)
+    {
+        red   += color.r;
+        green += color.g;
+        blue  += color.b;
+        pixels++;
+    }
+
+    void Add(const CRGB * pColors, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+            Add(pColors[i]);
+    }
+
+    // Power in mW, given what a pixel draws with one channel at full brightness and what a dark pixel draws
+    uint32_t Milliwatts(float redPower, float greenPower, float bluePower, float darkPower = 0.0f) const
+    {
+        return (uint32_t) ((red * redPower + green * greenPower + blue * bluePower) / 255.0f + pixels * darkPower);
+    }
+};
+
+// PowerLimiter
+//
+// Picks the brightness for the next frame from the power (at full brightness) that the last two frames
+// drew. The prediction follows the trend between those frames when power is going up, so that a limit is
+// anticipated rather than overshot for a frame.  Like the matrix limiter it replaced, it lowers brightness
+// right away, but brings it back up gradually to avoid flicker.
+
+class PowerLimiter
+{
+    uint32_t _lastPower     = 0;
+    uint32_t _previousPower = 0;
+    uint8_t  _brightness    = 255;
+
+    static constexpr int kRampFrames = 10;          // Roughly how many frames a brightness increase is spread over
+
+  public:
+
+    // Records what the latest frame draws at full brightness, in mW
+    void AddFrame(uint32_t power)
+    {
+        _previousPower = _lastPower;
+        _lastPower = power;
+    }
+
+    // Brightness (0-255) that should keep the next frame within 'limit' mW
+    uint8_t Brightness(uint32_t limit)
+    {
+        uint32_t predicted = _lastPower;
+        if (_lastPower > _previousPower)
+            predicted += (_lastPower - _previousPower) / 2;
+
+        uint8_t target = predicted <= limit ? 255 : (uint8_t) ((uint64_t) limit * 255 / predicted);
+
+        if (target <= _brightness)
+            _brightness = target;
+        else
+            _brightness = std::max(_brightness + 1, (_brightness * (kRampFrames - 1) + target) / kRampFrames);
+
+        return _brightness;
+    }
+};
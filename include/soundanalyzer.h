@@ -33,6 +33,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <arduinoFFT.h>
 #include <driver/i2s.h>
 #include <driver/adc.h>
@@ -58,6 +59,7 @@ struct AudioVariables
     int _AudioFPS           = 0;            // Framerate of the audio sampler
     int _serialFPS          = 0;            // How many serial packets are processed per second
     uint _msLastRemote      = 0;            // When the last Peak data came in from external (ie: WiFi)
+    std::atomic_bool _replaying = false;    // Set while an effect replay scripts these values (see effectsources.h)
 };
 
 #if !ENABLE_AUDIO
@@ -34,6 +34,7 @@
 #include "taskmgr.h"
 #include "jsonserializer.h"
 #include "network.h"
+#include "httpfetcher.h"
 #include "deviceconfig.h"
 #include "screen.h"
 #include "socketserver.h"
@@ -252,6 +253,13 @@ class SystemContainer
         SC_SIMPLE_PROPERTY(NetworkReader, NetworkReader)
     #endif
 
+    // -------------------------------------------------------------
+    // HTTPFetcher
+
+    #if ENABLE_WIFI
+        SC_SIMPLE_PROPERTY(HTTPFetcher, HTTPFetcher)
+    #endif
+
     // -------------------------------------------------------------
     // WebServer
 
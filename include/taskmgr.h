@@ -61,6 +61,9 @@
 #define DEBUG_STACK_SIZE   8192                 // Needs a lot of stack for output if UpdateClockFromWeb is called from debugger
 #define REMOTE_STACK_SIZE  4096
 #define SCREEN_STACK_SIZE  8192
+#define PREFETCH_STACK_SIZE 8192                // Effect constructors and JSON unpacking can be stack-hungry
+#define HTTPFETCH_STACK_SIZE 8192               // Fetch callbacks parse JSON on this stack
+#define NET_READER_STACK_SIZE 4096              // For network readers that run on a task of their own
 
 class IdleTask
 {
@@ -209,6 +212,8 @@ void IRAM_ATTR SocketServerTaskEntry(void *);
 void IRAM_ATTR RemoteLoopEntry(void *);
 void IRAM_ATTR JSONWriterTaskEntry(void *);
 void IRAM_ATTR ColorDataTaskEntry(void *);
+void IRAM_ATTR EffectPrefetchTaskEntry(void *);
+void IRAM_ATTR HTTPFetchTaskEntry(void *);
 
 #define DELETE_TASK(handle) if (handle != nullptr) vTaskDelete(handle)
 
@@ -241,8 +246,10 @@ private:
     TaskHandle_t _taskSerial        = nullptr;
     TaskHandle_t _taskColorData     = nullptr;
     TaskHandle_t _taskJSONWriter    = nullptr;
+    TaskHandle_t _taskPrefetch      = nullptr;
 
     std::vector<TaskHandle_t> _vEffectTasks;
+    std::vector<TaskHandle_t> _vHTTPFetchTasks;
 
     static void EffectTaskEntry(void *pVoid)
     {
@@ -264,6 +271,9 @@ public:
         for (auto& task : _vEffectTasks)
             vTaskDelete(task);
 
+        for (auto& task : _vHTTPFetchTasks)
+            vTaskDelete(task);
+
         DELETE_TASK(_taskDraw);
         DELETE_TASK(_taskScreen);
         DELETE_TASK(_taskRemote);
@@ -273,6 +283,7 @@ public:
         DELETE_TASK(_taskSocket);
         DELETE_TASK(_taskNetwork);
         DELETE_TASK(_taskJSONWriter);
+        DELETE_TASK(_taskPrefetch);
         DELETE_TASK(_taskDebug);
     }
 
@@ -372,6 +383,40 @@ public:
         xTaskNotifyGive(_taskJSONWriter);
     }
 
+    void StartEffectPrefetchThread()
+    {
+        #if EFFECT_PREFETCH
+            Serial.print( str_sprintf(">> Launching Effect Prefetch Thread.  Mem: %u, LargestBlk: %u, PSRAM Free: %u/%u, ", ESP.getFreeHeap(),ESP.getMaxAllocHeap(), ESP.getFreePsram(), ESP.getPsramSize()) );
+            xTaskCreatePinnedToCore(EffectPrefetchTaskEntry, "Effect Prefetch Loop", PREFETCH_STACK_SIZE, nullptr, PREFETCH_PRIORITY, &_taskPrefetch, PREFETCH_CORE);
+            CheckHeap();
+        #endif
+    }
+
+    void NotifyEffectPrefetchThread()
+    {
+        if (_taskPrefetch == nullptr)
+            return;
+
+        // Wake up the prefetch task; it will pick up whatever effect the EffectManager asks for
+        xTaskNotifyGive(_taskPrefetch);
+    }
+
+    void StartHTTPFetchThreads()
+    {
+        #if ENABLE_WIFI
+            for (int i = 0; i < HTTP_FETCH_WORKERS; i++)
+            {
+                Serial.print( str_sprintf(">> Launching HTTP Fetch Thread %d.  Mem: %u, LargestBlk: %u, PSRAM Free: %u/%u, ", i, ESP.getFreeHeap(),ESP.getMaxAllocHeap(), ESP.getFreePsram(), ESP.getPsramSize()) );
+
+                TaskHandle_t fetchTask = nullptr;
+                if (xTaskCreatePinnedToCore(HTTPFetchTaskEntry, "HTTP Fetch Loop", HTTPFETCH_STACK_SIZE, nullptr, HTTPFETCH_PRIORITY, &fetchTask, HTTPFETCH_CORE) == pdPASS)
+                    _vHTTPFetchTasks.push_back(fetchTask);
+
+                CheckHeap();
+            }
+        #endif
+    }
+
     void NotifyNetworkThread()
     {
         if (_taskNetwork == nullptr)
@@ -0,0 +1,173 @@
+//+--------------------------------------------------------------------------
+//
+// File:        textcache.h
+//
+// NightDriverStrip - (c) 2026 Plummer's Software LLC.  All Rights Reserved.
+//
+// This file is part of the NightDriver software project.
+//
+//    NightDriver is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    NightDriver is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with Nightdriver.  It is normally found in copying.txt
+//    If not, see <https://www.gnu.org/licenses/>.
+//
+// Description:
+//
+//    Cache of strings rendered in Adafruit GFX fonts.  Printing through
+//    Adafruit_GFX unpacks every glyph bit by bit on every call, which adds
+//    up for the info effects that redraw the same few strings every frame.
+//    Here a string is unpacked once into a mask of the pixels it covers,
+//    and drawing it again is a matter of walking that mask.
+//
+//    Text that's drawn through SmartMatrix's own drawString(), like the
+//    digits of the pong clock, never goes through Adafruit_GFX and so
+//    isn't covered by this cache.
+//
+//---------------------------------------------------------------------------
+
+#pragma once
+
+#include <map>
+#include <utility>
+#include <vector>
+#include <Arduino.h>
+#include <gfxfont.h>
+
+// RenderedText
+//
+// A string as rendered in a particular font. The mask has one bit per pixel, row by row, for a box that starts
+// (x0, y0) from the cursor position; as with Adafruit_GFX, that position is on the baseline of the text.
+
+struct RenderedText
+{
+    int16_t  x0     = 0;
+    int16_t  y0     = 0;
+    uint16_t width  = 0;
+    uint16_t height = 0;
+    std::vector<uint8_t> mask;
+
+    bool IsSet(uint16_t x, uint16_t y) const
+    {
+        size_t bit = y * width + x;
+        return mask[bit / 8] & (0x80 >> (bit % 8));
+    }
+};
+
+// TextCache
+//
+// Maps text and font to their RenderedText.  Colors aren't part of the key, as they are applied when drawing.
+// Text is laid out on a single line; unlike Adafruit_GFX, it is never wrapped at the edge of the display.
+
+class TextCache
+{
+    static constexpr size_t kMaxEntries = 16;       // The whole cache is emptied when it gets this full
+
+    std::map<std::pair<const GFXfont *, String>, RenderedText> _entries;
+
+    static const GFXglyph * Glyph(const GFXfont * pFont, char c)
+    {
+        uint8_t ch = (uint8_t) c;
+        if (ch < pFont->first || ch > pFont->last)
+            return nullptr;
+
+        return &pFont->glyph[ch - pFont->first];
+    }
+
+    static RenderedText Render(const GFXfont * pFont, const String& text)
+    {
+        RenderedText rendered;
+
+        // First find the box all the glyphs together cover
+
+        int16_t minX = INT16_MAX, minY = INT16_MAX, maxX = INT16_MIN, maxY = INT16_MIN;
+        int16_t cursorX = 0;
+
+        for (char c : text)
+        {
+            auto pGlyph = Glyph(pFont, c);
+            if (!pGlyph)
+                continue;
+
+            if (pGlyph->width > 0 && pGlyph->height > 0)
+            {
+                minX = std::min<int16_t>(minX, cursorX + pGlyph->xOffset);
+                maxX = std::max<int16_t>(maxX, cursorX + pGlyph->xOffset + pGlyph->width);
+                minY = std::min<int16_t>(minY, pGlyph->yOffset);
+                maxY = std::max<int16_t>(maxY, pGlyph->yOffset + pGlyph->height);
+            }
+            cursorX += pGlyph->xAdvance;
+        }
+
+        if (minX >= maxX || minY >= maxY)
+            return rendered;
+
+        rendered.x0 = minX;
+        rendered.y0 = minY;
+        rendered.width = maxX - minX;
+        rendered.height = maxY - minY;
+        rendered.mask.resize((rendered.width * rendered.height + 7) / 8);
+
+        // Then unpack the glyph bitmaps into it; they are packed bit by bit, row after row
+
+        cursorX = 0;
+        for (char c : text)
+        {
+            auto pGlyph = Glyph(pFont, c);
+            if (!pGlyph)
+                continue;
+
+            const uint8_t * pBitmap = pFont->bitmap + pGlyph->bitmapOffset;
+            uint8_t bits = 0;
+            uint16_t bitIndex = 0;
+
+            for (uint16_t gy = 0; gy < pGlyph->height; gy++)
+            {
+                for (uint16_t gx = 0; gx < pGlyph->width; gx++, bitIndex++)
+                {
+                    if ((bitIndex & 7) == 0)
+                        bits = pBitmap[bitIndex / 8];
+
+                    if (bits & 0x80)
+                    {
+                        size_t bit = (pGlyph->yOffset + gy - minY) * rendered.width + (cursorX + pGlyph->xOffset + gx - minX);
+                        rendered.mask[bit / 8] |= 0x80 >> (bit % 8);
+                    }
+                    bits <<= 1;
+                }
+            }
+            cursorX += pGlyph->xAdvance;
+        }
+
+        return rendered;
+    }
+
+  public:
+
+    const RenderedText & Get(const GFXfont * pFont, const String& text)
+    {
+        auto key = std::make_pair(pFont, text);
+
+        auto entry = _entries.find(key);
+        if (entry != _entries.end())
+            return entry->second;
+
+        if (_entries.size() >= kMaxEntries)
+            _entries.clear();
+
+        return _entries.emplace(key, Render(pFont, text)).first->second;
+    }
+
+    void Clear()
+    {
+        _entries.clear();
+    }
+};
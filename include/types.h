@@ -259,6 +259,20 @@ inline void * PreferPSRAMAlloc(size_t s)
     }
 }
 
+// TryPreferPSRAMAlloc
+//
+// Like PreferPSRAMAlloc, but returns nullptr instead of throwing when there's no memory to be had, for callers that
+// have something sensible to fall back on
+
+inline void * TryPreferPSRAMAlloc(size_t s)
+{
+    auto p = psramInit() ? ps_malloc(s) : malloc(s);
+    if (!p)
+        debugW("Allocation failed for %u bytes\n", s);
+
+    return p;
+}
+
 // psram_allocator
 //
 // A C++ allocator that allocates from PSRAM instead of the regular heap. Initially
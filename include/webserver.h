@@ -40,6 +40,7 @@
 #pragma once
 
 #include "deviceconfig.h"
+#include "effectmanager.h"
 #include "network.h"
 
 #include <Arduino.h>
@@ -51,9 +52,13 @@
 #include <HTTPClient.h>
 #include <SPIFFS.h>
 #include <WiFi.h>
+#include <atomic>
 #include <map>
+#include <esp_rom_crc.h>
 
-class CWebServer
+// The web server listens to effect events to know when the cached responses for effect endpoints are stale
+
+class CWebServer : public IEffectEventListener
 {
   public:
 
@@ -77,6 +82,10 @@ class CWebServer
     // Value validating function type, as used by DeviceConfig (and possible others)
     using ValueValidator = std::function<DeviceConfig::ValidateResponse(const String&)>;
 
+    // Function that produces the next piece of a chunked JSON response into the String it's passed, and
+    //   returns false once it has produced the last piece. Used by BeginChunkedJsonResponse()
+    using JsonChunkProducer = std::function<bool(String&)>;
+
     // Device stats that don't change after startup
     struct StaticStatistics
     {
@@ -97,17 +106,37 @@ class CWebServer
         // Added to hold the file's MIME type, but could be used for other type types, if desired
         const char *const type;
         const char *const encoding;
+        // The contents never change while we run, so their CRC makes a perfectly good entity tag
+        const String etag;
 
         EmbeddedWebFile(const uint8_t* start, const uint8_t* end, const char* type, const char* encoding = nullptr)
-            : EmbeddedFile(start, end), type(type), encoding(encoding)
+            : EmbeddedFile(start, end), type(type), encoding(encoding),
+              etag(str_sprintf("\"%08x\"", (unsigned) esp_rom_crc32_le(0, start, end - start)))
         {
         }
     };
 
+    // A pre-serialized JSON body, along with the revision of the data it was serialized from
+    struct CachedJsonBody
+    {
+        uint32_t revision = 0;
+        std::shared_ptr<const String> body;
+    };
+
     static std::vector<SettingSpec, psram_allocator<SettingSpec>> mySettingSpecs;
     static std::vector<std::reference_wrapper<SettingSpec>> deviceSettingSpecs;
     static const std::map<String, ValueValidator> settingValidators;
 
+    // Revision of the effect list (order, names, enabled states). This is bumped by the IEffectEventListener
+    //   overrides, which may be called from any task.
+    static std::atomic<uint32_t> effectListRevision;
+
+    // Pre-serialized bodies for endpoints the web UI polls a lot, but that rarely change. These are only used by
+    //   request handlers, which all run on the web server's task, so they need no locking.
+    static CachedJsonBody cachedEffectList;
+    static std::shared_ptr<const String> cachedDeviceSettingSpecs;
+    static std::map<size_t, CachedJsonBody> cachedEffectSettingSpecs;
+
     AsyncWebServer _server;
     StaticStatistics _staticStats;
 
@@ -160,9 +189,14 @@ class CWebServer
     // Straightforward support functions
 
     static void SendBufferOverflowResponse(AsyncWebServerRequest * pRequest);
+    static AsyncWebServerResponse * BeginChunkedJsonResponse(AsyncWebServerRequest * pRequest, JsonChunkProducer producer);
     static bool IsPostParamTrue(AsyncWebServerRequest * pRequest, const String & paramName);
+    static bool SendNotModifiedIfMatch(AsyncWebServerRequest * pRequest, const String & etag);
+    static void SendCachedJsonResponse(AsyncWebServerRequest * pRequest, const String & etag, std::shared_ptr<const String> body,
+                                       const String & prefix = String(), const String & suffix = String());
+    static std::shared_ptr<const String> SerializeEffectList();
+    static std::shared_ptr<const String> SerializeSettingSpecs(const std::vector<std::reference_wrapper<SettingSpec>> & settingSpecs);
     static const std::vector<std::reference_wrapper<SettingSpec>> & LoadDeviceSettingSpecs();
-    static void SendSettingSpecsResponse(AsyncWebServerRequest * pRequest, const std::vector<std::reference_wrapper<SettingSpec>> & settingSpecs);
     static void SetSettingsIfPresent(AsyncWebServerRequest * pRequest);
     static long GetEffectIndexFromParam(AsyncWebServerRequest * pRequest, bool post = false);
     static bool CheckAndGetSettingsEffect(AsyncWebServerRequest * pRequest, std::shared_ptr<LEDStripEffect> & effect, bool post = false);
@@ -172,6 +206,7 @@ class CWebServer
     // Endpoint member functions
 
     static void GetEffectListText(AsyncWebServerRequest * pRequest);
+    static void GetEffectsConfig(AsyncWebServerRequest * pRequest);
     static void GetSettingSpecs(AsyncWebServerRequest * pRequest);
     static void GetSettings(AsyncWebServerRequest * pRequest);
     static void SetSettings(AsyncWebServerRequest * pRequest);
@@ -186,6 +221,9 @@ class CWebServer
     static void MoveEffect(AsyncWebServerRequest * pRequest);
     static void CopyEffect(AsyncWebServerRequest * pRequest);
     static void DeleteEffect(AsyncWebServerRequest * pRequest);
+    static void ApplyEffectOperations(AsyncWebServerRequest * pRequest);
+    static void RecordFrameHashes(AsyncWebServerRequest * pRequest);
+    static void GetFrameHashes(AsyncWebServerRequest * pRequest);
     static void NextEffect(AsyncWebServerRequest * pRequest);
     static void PreviousEffect(AsyncWebServerRequest * pRequest);
 
@@ -193,16 +231,23 @@ class CWebServer
     void GetStatistics(AsyncWebServerRequest * pRequest, StatisticsType statsType = StatisticsType::All) const;
 
     // This registers a handler for GET requests for one of the known files embedded in the firmware.
+    //   Browsers that already have the file get a 304 instead of the whole (compressed) file.
     void ServeEmbeddedFile(const char strUri[], EmbeddedWebFile &file)
     {
         _server.on(strUri, HTTP_GET, [strUri, file](AsyncWebServerRequest *request)
         {
             Serial.printf("GET for: %s\n", strUri);
+
+            if (SendNotModifiedIfMatch(request, file.etag))
+                return;
+
             AsyncWebServerResponse *response = request->beginResponse(200, file.type, file.contents, file.length);
             if (file.encoding)
             {
                 response->addHeader("Content-Encoding", file.encoding);
             }
+            response->addHeader("ETag", file.etag);
+            response->addHeader("Cache-Control", "no-cache");
 
             AddCORSHeaderAndSendResponse(request, response);
         });
@@ -220,6 +265,28 @@ class CWebServer
     {
         _server.addHandler(&webSocket);
     }
+
+    // IEffectEventListener overrides, used to invalidate cached responses
+
+    // The playback state isn't part of any cached response, so there's nothing to do for it
+
+    void OnCurrentEffectChanged(size_t currentEffectIndex) override
+    {
+    }
+
+    void OnEffectListDirty() override
+    {
+        effectListRevision++;
+    }
+
+    void OnEffectEnabledStateChanged(size_t effectIndex, bool newState) override
+    {
+        effectListRevision++;
+    }
+
+    void OnIntervalChanged(uint interval) override
+    {
+    }
 };
 
 inline CWebServer::StatisticsType operator|(CWebServer::StatisticsType lhs, CWebServer::StatisticsType rhs)
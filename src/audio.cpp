@@ -54,6 +54,13 @@ void IRAM_ATTR AudioSamplerTaskEntry(void *)
 
     for (;;)
     {
+        // While an effect is being replayed, the audio variables are scripted and must be left alone
+        if (g_Analyzer._replaying)
+        {
+            delay(10);
+            continue;
+        }
+
         auto lastFrame = millis();
 
         g_Analyzer.RunSamplerPass();
@@ -37,6 +37,7 @@ extern const char timezones_start[] asm("_binary_config_timezones_json_start");
 
 void DeviceConfig::SaveToJSON() const
 {
+    revision++;
     g_ptrSystem->JSONWriter().FlagWriter(writerIndex);
 }
 
@@ -197,4 +198,4 @@ void DeviceConfig::ApplyColorSettings(std::optional<CRGB> newGlobalColor, std::o
     // ...otherwise, apply the "set global color" logic if we were asked to do so
     else if (forceApplyGlobalColor)
         g_ptrSystem->EffectManager().ApplyGlobalColor(finalGlobalColor);
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -289,6 +289,8 @@ void IRAM_ATTR DrawLoopTaskEntry(void *)
             ShowOnboardPixel();
             ShowOnboardRGBLED();
 
+            graphics->UpdateDirtyRect();
+
             g_Values.FPS = FastLED.getFPS();
             g_ptrSystem->EffectManager().ReportNewFrameAvailable();
         }
@@ -298,7 +300,7 @@ void IRAM_ATTR DrawLoopTaskEntry(void *)
         // Delay at least 2ms and not more than 1s until next frame is due
 
         constexpr auto minimumDelay = 5;
-        delay( std::max(minimumDelay, CalcDelayUntilNextFrame(frameStartTime, localPixelsDrawn, wifiPixelsDrawn) ));
+        graphics->WaitForNextFrame( std::max(minimumDelay, CalcDelayUntilNextFrame(frameStartTime, localPixelsDrawn, wifiPixelsDrawn) ));
 
         // Once an OTA flash update has started, we don't want to hog the CPU or it goes quite slowly,
         // so we'll slow down to share the CPU a bit once the update has begun
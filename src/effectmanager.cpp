@@ -29,9 +29,12 @@
 
 #include <FS.h>
 #include <SPIFFS.h>
+#include <sys/time.h>
+#include <esp_rom_crc.h>
 
 #include "globals.h"
 #include "systemcontainer.h"
+#include "effectstore.h"
 
 #include "effects/strip/misceffects.h"
 
@@ -42,6 +45,7 @@ extern std::map<int, JSONEffectFactory> g_JsonStarryNightEffectFactories;
 DRAM_ATTR size_t g_EffectsManagerJSONBufferSize = 0;
 static DRAM_ATTR size_t l_EffectsManagerJSONWriterIndex = SIZE_MAX;
 static DRAM_ATTR size_t l_CurrentEffectWriterIndex = SIZE_MAX;
+static EffectConfigStore l_EffectConfigStore;
 
 //
 // EffectManager initialization functions
@@ -61,7 +65,7 @@ static DRAM_ATTR size_t l_CurrentEffectWriterIndex = SIZE_MAX;
 // Declare these here just so InitEffectsManager can refer to them. They're defined elsewhere or further down.
 
 void LoadEffectFactories();
-std::optional<JsonObjectConst> LoadEffectsJSONFile(JsonDocument& jsonDoc);
+std::optional<JsonObjectConst> LoadEffectsConfig(JsonDocument& jsonDoc, EffectConfigStore& effectStore);
 void WriteCurrentEffectIndexFile();
 
 // InitEffectsManager
@@ -75,13 +79,13 @@ void InitEffectsManager()
 
     l_EffectsManagerJSONWriterIndex = g_ptrSystem->JSONWriter().RegisterWriter([]()
     {
-        if (!SaveToJSONFile(EFFECTS_CONFIG_FILE, g_ptrSystem->EffectManager()) && EFFECT_PERSISTENCE_CRITICAL)
+        if (!l_EffectConfigStore.Save(g_ptrSystem->EffectManager()) && EFFECT_PERSISTENCE_CRITICAL)
             throw std::runtime_error("Effects serialization failed");
     });
     l_CurrentEffectWriterIndex = g_ptrSystem->JSONWriter().RegisterWriter(WriteCurrentEffectIndexFile);
 
     auto jsonDoc = CreateJsonDocument();
-    auto jsonObject = LoadEffectsJSONFile(jsonDoc);
+    auto jsonObject = LoadEffectsConfig(jsonDoc, l_EffectConfigStore);
 
     if (jsonObject)
     {
@@ -111,12 +115,82 @@ void InitEffectsManager()
     #if EFFECTS_WEB_SOCKET_ENABLED
         g_ptrSystem->EffectManager().AddEffectEventListener(g_ptrSystem->WebSocketServer());
     #endif
+
+    #if ENABLE_WIFI && ENABLE_WEBSERVER
+        // The web server caches some effect-related responses, and needs to know when they're outdated
+        g_ptrSystem->EffectManager().AddEffectEventListener(g_ptrSystem->WebServer());
+    #endif
 }
 
 //
 // EffectManager member function definitions
 //
 
+bool EffectManager::ApplyEffectListOperations(const std::vector<EffectListOperation>& operations)
+{
+    // Operations don't change the size of the effect list, so we can check all indexes before we touch anything
+    for (auto& operation : operations)
+    {
+        if (operation.index >= _vEffects.size()
+            || (operation.type == EffectListOperation::Type::Move && operation.newIndex >= _vEffects.size()))
+        {
+            debugW("Invalid index in effect list operations, none applied");
+            return false;
+        }
+    }
+
+    if (operations.empty())
+        return true;
+
+    bool effectsWereEnabled = AreEffectsEnabled();
+    bool currentEffectMoved = false;
+
+    {
+        std::lock_guard<std::mutex> guard(_effectLoadMutex);
+
+        for (auto& operation : operations)
+        {
+            switch (operation.type)
+            {
+                case EffectListOperation::Type::Enable:
+                case EffectListOperation::Type::Disable:
+                {
+                    bool enable = operation.type == EffectListOperation::Type::Enable;
+                    auto& entry = _vEffects[operation.index];
+
+                    if (entry.IsEnabled() != enable)
+                        entry.SetEnabled(enable);
+
+                    break;
+                }
+
+                case EffectListOperation::Type::Move:
+                    if (operation.index != operation.newIndex)
+                        currentEffectMoved = MoveEntry(operation.index, operation.newIndex) || currentEffectMoved;
+                    break;
+            }
+        }
+    }
+
+    // Do what EnableEffect() and DisableEffect() do when the last effect is disabled or the first one enabled
+    bool effectsAreEnabled = AreEffectsEnabled();
+
+    if (!effectsWereEnabled && effectsAreEnabled)
+        ClearRemoteColor(true);
+    else if (effectsWereEnabled && !effectsAreEnabled)
+        ApplyGlobalColor(CRGB::Black);
+
+    if (currentEffectMoved)
+        SaveCurrentEffectIndex();
+
+    SaveEffectManagerConfig();
+
+    // One notification covers all changes; listeners will reload the effect list as a whole
+    INFORM_EVENT_LISTENERS(_effectEventListeners, IEffectEventListener::OnEffectListDirty);
+
+    return true;
+}
+
 void EffectManager::SaveCurrentEffectIndex()
 {
     if (g_ptrSystem->DeviceConfig().RememberCurrentEffect())
@@ -126,6 +200,9 @@ void EffectManager::SaveCurrentEffectIndex()
 
 bool EffectManager::ReadCurrentEffectIndex(size_t& index)
 {
+    // The file is written by ReplaceFileContents(), so a write may have been cut short
+    RecoverReplacedFile(CURRENT_EFFECT_CONFIG_FILE);
+
     File file = SPIFFS.open(CURRENT_EFFECT_CONFIG_FILE);
     bool readIndex = false;
 
@@ -165,15 +242,9 @@ void EffectManager::LoadJSONAndMissingEffects(const JsonArrayConst& effectsArray
         if (factoryEntry == jsonFactories.end())
             continue;
 
-        auto pEffect = factoryEntry->second(effectObject);
-        if (pEffect)
-        {
-            if (effectObject[PTY_COREEFFECT].as<int>())
-                pEffect->MarkAsCoreEffect();
-
-            _vEffects.push_back(pEffect);
-            loadedEffectNumbers.insert(effectNumber);
-        }
+        // The effect itself is only created when it's first played; for now we just keep its configuration
+        _vEffects.emplace_back(effectObject);
+        loadedEffectNumbers.insert(effectNumber);
     }
 
     // Now add missing effects from the default factory list
@@ -211,10 +282,10 @@ std::shared_ptr<LEDStripEffect> EffectManager::CopyEffect(size_t index)
         return nullptr;
     }
 
-    auto& sourceEffect = _vEffects[index];
+    auto& sourceEntry = _vEffects[index];
 
     auto jsonEffectFactories = g_ptrEffectFactories->GetJSONFactories();
-    auto factoryEntry = jsonEffectFactories.find(sourceEffect->EffectNumber());
+    auto factoryEntry = jsonEffectFactories.find(sourceEntry.EffectNumber());
 
     if (factoryEntry == jsonEffectFactories.end())
         return nullptr;
@@ -222,10 +293,15 @@ std::shared_ptr<LEDStripEffect> EffectManager::CopyEffect(size_t index)
     auto jsonDoc = CreateJsonDocument();
     auto jsonObject = jsonDoc.to<JsonObject>();
 
-    if (!sourceEffect->SerializeToJSON(jsonObject))
     {
-        debugE("Could not serialize effect %s to JSON", sourceEffect->FriendlyName().c_str());
-        return nullptr;
+        // The entry may be loaded or unloaded by the draw and prefetch tasks while we serialize it
+        std::lock_guard<std::mutex> guard(_effectLoadMutex);
+
+        if (!sourceEntry.SerializeToJSON(jsonObject))
+        {
+            debugE("Could not serialize effect %s to JSON", sourceEntry.FriendlyName().c_str());
+            return nullptr;
+        }
     }
 
     auto copiedEffect = factoryEntry->second(jsonDoc.as<JsonObjectConst>());
@@ -239,46 +315,205 @@ std::shared_ptr<LEDStripEffect> EffectManager::CopyEffect(size_t index)
 }
 
 //
-// Helper functions related to JSON persistence
+// EffectEntry member function definitions
 //
 
-void SaveEffectManagerConfig()
+std::shared_ptr<LEDStripEffect> EffectEntry::Construct(int effectNumber, bool coreEffect, const PackedEffectConfig& config)
 {
-    debugV("Saving effect manager config...");
-    // Default value for writer index is max value for size_t, so nothing will happen if writer has not yet been registered
-    g_ptrSystem->JSONWriter().FlagWriter(l_EffectsManagerJSONWriterIndex);
+    auto& jsonFactories = g_ptrEffectFactories->GetJSONFactories();
+    auto factoryEntry = jsonFactories.find(effectNumber);
+
+    if (factoryEntry == jsonFactories.end())
+    {
+        debugE("No JSON factory for effect number %d", effectNumber);
+        return nullptr;
+    }
+
+    auto jsonDoc = CreateJsonDocument();
+    auto error = deserializeMsgPack(jsonDoc, config.data(), config.size());
+
+    if (error)
+    {
+        debugE("Could not unpack configuration of effect number %d: %s", effectNumber, error.c_str());
+        return nullptr;
+    }
+
+    auto pEffect = factoryEntry->second(jsonDoc.as<JsonObjectConst>());
+    if (!pEffect)
+        return nullptr;
+
+    if (coreEffect)
+        pEffect->MarkAsCoreEffect();
+
+    return pEffect;
 }
 
-void RemoveEffectManagerConfig()
+std::shared_ptr<LEDStripEffect> EffectEntry::Instantiate() const
 {
-    RemoveJSONFile(EFFECTS_CONFIG_FILE);
-    // We take the liberty of also removing the file with the current effect config index
-    SPIFFS.remove(CURRENT_EFFECT_CONFIG_FILE);
+    if (_effect)
+        return _effect;
+
+    auto pEffect = Construct(_effectNumber, _coreEffect, _serialized);
+    if (!pEffect)
+        return nullptr;
+
+    Adopt(pEffect, _serialized);
+
+    return _effect;
 }
 
-void WriteCurrentEffectIndexFile()
+bool EffectEntry::Adopt(const std::shared_ptr<LEDStripEffect>& effect, const PackedEffectConfig& config) const
+{
+    if (_effect || _serialized != config)
+        return false;
+
+    _effect = effect;
+    _initialized = false;
+    _serialized.clear();
+    _serialized.shrink_to_fit();
+
+    return true;
+}
+
+std::shared_ptr<LEDStripEffect> EffectEntry::Load(const std::vector<std::shared_ptr<GFXBase>>& gfx) const
 {
-    SPIFFS.remove(CURRENT_EFFECT_CONFIG_FILE);
+    auto pEffect = Instantiate();
+    if (!pEffect || _initialized)
+        return pEffect;
 
-    File file = SPIFFS.open(CURRENT_EFFECT_CONFIG_FILE, FILE_WRITE);
+    // Init() wants a non-const list of devices, so it gets its own copy
+    auto gfxCopy = gfx;
 
-    if (!file)
+    debugV("About to init effect %s", _friendlyName.c_str());
+    if (!pEffect->Init(gfxCopy))
     {
-        debugE("Unable to open file %s for writing!", CURRENT_EFFECT_CONFIG_FILE);
+        debugW("Could not initialize effect: %s", _friendlyName.c_str());
+        return nullptr;
+    }
+
+    _initialized = true;
+
+    debugV("Loaded Effect: %s", _friendlyName.c_str());
+
+    return pEffect;
+}
+
+void EffectEntry::Unload()
+{
+    if (!_effect || _effect.use_count() > 1)
+        return;
+
+    if (g_ptrEffectFactories->GetJSONFactories().count(_effectNumber) == 0)
+        return;
+
+    auto jsonDoc = CreateJsonDocument();
+    auto jsonObject = jsonDoc.to<JsonObject>();
+
+    if (!_effect->SerializeToJSON(jsonObject))
+    {
+        debugW("Could not serialize effect %s, keeping it loaded", _effect->FriendlyName().c_str());
         return;
     }
 
-    auto bytesWritten = file.print(g_ptrSystem->EffectManager().GetCurrentEffectIndex());
-    debugI("Number of bytes written to file %s: %zu", CURRENT_EFFECT_CONFIG_FILE, bytesWritten);
+    _friendlyName = _effect->FriendlyName();
+    _enabled = _effect->IsEnabled();
+
+    _serialized.resize(measureMsgPack(jsonDoc));
+    serializeMsgPack(jsonDoc, _serialized.data(), _serialized.size());
 
-    file.flush();
-    file.close();
+    _effect.reset();
+    _initialized = false;
+}
+
+bool EffectEntry::SerializeToJSON(JsonObject& jsonObject) const
+{
+    if (_effect)
+        return _effect->SerializeToJSON(jsonObject);
+
+    auto jsonDoc = CreateJsonDocument();
+    auto error = deserializeMsgPack(jsonDoc, _serialized.data(), _serialized.size());
 
-    if (bytesWritten == 0)
+    if (error)
     {
-        debugE("Unable to write to file %s!", CURRENT_EFFECT_CONFIG_FILE);
-        SPIFFS.remove(CURRENT_EFFECT_CONFIG_FILE);
+        debugE("Could not unpack configuration of effect %s: %s", _friendlyName.c_str(), error.c_str());
+        return false;
+    }
+
+    return SetIfNotOverflowed(jsonDoc, jsonObject, __PRETTY_FUNCTION__);
+}
+
+bool EffectEntry::SerializeToMsgPack(PackedEffectConfig& buffer) const
+{
+    if (!_effect)
+    {
+        buffer = _serialized;
+        return true;
+    }
+
+    auto jsonDoc = CreateJsonDocument();
+    auto jsonObject = jsonDoc.to<JsonObject>();
+
+    if (!_effect->SerializeToJSON(jsonObject))
+        return false;
+
+    buffer.resize(measureMsgPack(jsonDoc));
+    serializeMsgPack(jsonDoc, buffer.data(), buffer.size());
+
+    return true;
+}
+
+void EffectEntry::SetEnabled(bool enabled)
+{
+    _enabled = enabled;
+
+    if (_effect)
+    {
+        _effect->SetEnabled(enabled);
+        return;
     }
+
+    // Keep the packed configuration in step, so it can be loaded and persisted as-is
+    auto jsonDoc = CreateJsonDocument();
+
+    if (deserializeMsgPack(jsonDoc, _serialized.data(), _serialized.size()))
+    {
+        debugE("Could not unpack configuration of effect %s", _friendlyName.c_str());
+        return;
+    }
+
+    jsonDoc["es"] = enabled ? 1 : 0;
+
+    _serialized.resize(measureMsgPack(jsonDoc));
+    serializeMsgPack(jsonDoc, _serialized.data(), _serialized.size());
+}
+
+//
+// Helper functions related to JSON persistence
+//
+
+void SaveEffectManagerConfig()
+{
+    debugV("Saving effect manager config...");
+    // Default value for writer index is max value for size_t, so nothing will happen if writer has not yet been registered
+    g_ptrSystem->JSONWriter().FlagWriter(l_EffectsManagerJSONWriterIndex);
+}
+
+void RemoveEffectManagerConfig()
+{
+    l_EffectConfigStore.Remove();
+    // An effects JSON file may still be around if the config was never saved after upgrading
+    RemoveJSONFile(EFFECTS_CONFIG_FILE);
+    // We take the liberty of also removing the file with the current effect config index. It's not JSON, but it's
+    //   written the same way, so this also takes care of any temporary copy that would otherwise be recovered.
+    RemoveJSONFile(CURRENT_EFFECT_CONFIG_FILE);
+}
+
+void WriteCurrentEffectIndexFile()
+{
+    String indexString(g_ptrSystem->EffectManager().GetCurrentEffectIndex());
+
+    if (!ReplaceFileContents(CURRENT_EFFECT_CONFIG_FILE, (const uint8_t *) indexString.c_str(), indexString.length()))
+        debugE("Unable to write to file %s!", CURRENT_EFFECT_CONFIG_FILE);
 }
 
 // Helper function to create a StarryNightEffect from JSON.
@@ -320,16 +555,22 @@ std::shared_ptr<LEDStripEffect> GetSpectrumAnalyzer(CRGB color)
 
 bool EffectManager::Init()
 {
-    for (const auto & _vEffect : _vEffects)
+    if (_vEffects.empty())
     {
-        debugV("About to init effect %s", _vEffect->FriendlyName().c_str());
-        if (false == _vEffect->Init(_gfx))
-        {
-            debugW("Could not initialize effect: %s\n", _vEffect->FriendlyName().c_str());
-            return false;
-        }
-        debugV("Loaded Effect: %s", _vEffect->FriendlyName().c_str());
+        debugW("No effects to initialize");
+        return false;
+    }
+
+    // Effects are created and initialized when they're played, so the only one we need now is the first. If none
+    //   can be loaded right now, StartEffect() shows the blank effect and tries again on the next switch.
+    {
+        std::lock_guard<std::mutex> guard(_effectLoadMutex);
+        _currentEffect = LoadCurrentEffect();
     }
+
+    if (!_currentEffect)
+        debugE("Could not load any effect");
+
     debugV("First Effect: %s", GetCurrentEffectName().c_str());
 
     if (g_ptrSystem->DeviceConfig().ApplyGlobalColors())
@@ -338,6 +579,291 @@ bool EffectManager::Init()
     return true;
 }
 
+// CreateBlankEffect
+//
+// The blank effect is what we show when not a single effect can be loaded, so it's created up front.
+
+void EffectManager::CreateBlankEffect()
+{
+    _blankEffect = make_shared_psram<ColorFillEffect>("Blank", CRGB::Black, 1, true);
+    _blankEffect->Init(_gfx);
+}
+
+void EffectManager::CheckPrefetchNextEffect()
+{
+    if (_prefetchRequested || EffectCount() < 2)
+        return;
+
+    // Synchronized effects must be constructed after the random number generators have been seeded for their slot,
+    //   or devices would start out of step. See CheckSyncedEffectTimer().
+    if (IsPlaybackSynced())
+        return;
+
+    // Effects that play forever don't have a tail to do the prefetching in
+    if (GetEffectiveInterval() == std::numeric_limits<uint>::max())
+        return;
+
+    if (GetTimeRemainingForCurrentEffect() > EFFECT_PREFETCH_LEAD_TIME)
+        return;
+
+    _prefetchRequested = true;
+
+    size_t iNextEffect = GetNextEffectIndex();
+    if (iNextEffect == _iCurrentEffect || _vEffects[iNextEffect].IsLoaded())
+        return;
+
+    _iPrefetchEffect = iNextEffect;
+    g_ptrSystem->TaskManager().NotifyEffectPrefetchThread();
+}
+
+void EffectManager::PrefetchEffect()
+{
+    size_t index;
+    int effectNumber;
+    bool coreEffect;
+    PackedEffectConfig config;
+
+    // Pick up the request and copy what we need from the entry under the lock, so StartEffect() can't change its
+    //   mind about it halfway. The lock is released while the effect is built, so frames keep coming meanwhile.
+    {
+        std::lock_guard<std::mutex> guard(_effectLoadMutex);
+
+        index = _iPrefetchEffect.exchange(SIZE_MAX);
+        if (index >= _vEffects.size() || _vEffects[index].IsLoaded())
+            return;
+
+        effectNumber = _vEffects[index].EffectNumber();
+        coreEffect = _vEffects[index].IsCoreEffect();
+        config = _vEffects[index].PackedConfig();
+    }
+
+    auto startMs = millis();
+
+    // Construct the effect and let it do its device-independent setup (see LEDStripEffect::Prepare()). Init() is
+    //   left to the draw task, as effects are free to draw on the devices in there, and that would interfere with
+    //   the frame the current effect is drawing. Nobody else can see the effect yet, so this needs no lock.
+    auto effect = EffectEntry::Construct(effectNumber, coreEffect, config);
+    if (!effect || !effect->Prepare())
+    {
+        debugW("Could not prefetch effect number %d", effectNumber);
+        return;
+    }
+
+    // Hand it over, unless the list has changed or the draw task has loaded the effect itself in the meantime
+    std::lock_guard<std::mutex> guard(_effectLoadMutex);
+
+    if (index < _vEffects.size() && _vEffects[index].EffectNumber() == effectNumber && _vEffects[index].Adopt(effect, config))
+        debugV("Prefetched effect %s in %lums", effect->FriendlyName().c_str(), millis() - startMs);
+    else
+        debugV("Dropping prefetched effect number %d, as it's no longer needed", effectNumber);
+}
+
+bool EffectManager::RequestFrameHashRecording(size_t effectIndex, uint32_t seed, size_t frameCount)
+{
+    if (effectIndex >= EffectCount() || frameCount == 0 || frameCount > FRAME_HASH_MAX_FRAMES)
+        return false;
+
+    auto recording = std::make_shared<FrameHashRecording>();
+    recording->effectIndex = effectIndex;
+    recording->seed = seed;
+    recording->frameCount = frameCount;
+    recording->hashes.reserve(frameCount);
+
+    std::lock_guard<std::mutex> guard(_recordingMutex);
+
+    // Only one recording can be waiting; a newer request replaces an older one that hasn't started yet
+    _requestedRecording = recording;
+
+    return true;
+}
+
+// UpdateFrameHashRecording
+//
+// Called on the draw task for every frame. The first frame of a recording creates a new instance of the effect
+//   from its configuration, so what it draws doesn't depend on how long the regular instance has been running.
+//   The hash covers the LED buffers of all channels, right after the effect has drawn.
+
+bool EffectManager::UpdateFrameHashRecording()
+{
+    if (!_recording)
+    {
+        std::lock_guard<std::mutex> guard(_recordingMutex);
+
+        if (!_requestedRecording)
+            return false;
+
+        _recording = std::move(_requestedRecording);
+        _recordingActive = true;
+    }
+
+    if (!_recordingEffect)
+    {
+        debugI("Recording %zu frame hashes of effect %zu with seed %u", _recording->frameCount, _recording->effectIndex, (unsigned) _recording->seed);
+
+        // The random number generators are seeded first, as constructors and Init() functions draw from them too
+        _replaySources = std::make_shared<ReplayEffectSources>(_recording->seed);
+        _replaySources->Begin();
+
+        auto effect = CopyEffect(_recording->effectIndex);
+
+        if (!effect || !effect->Init(_gfx))
+        {
+            debugW("Could not create effect %zu for frame hash recording", _recording->effectIndex);
+            _recording->failed = true;
+            FinishFrameHashRecording();
+            return false;
+        }
+
+        effect->SetSources(_replaySources);
+        effect->Start();
+
+        _recordingEffect = effect;
+    }
+
+    _recordingEffect->Draw();
+
+    uint32_t crc = 0;
+    for (auto& gfx : _gfx)
+        crc = esp_rom_crc32_le(crc, (const uint8_t *) gfx->leds, gfx->GetLEDCount() * sizeof(CRGB));
+
+    _recording->hashes.push_back(crc);
+    _replaySources->NextFrame();
+
+    g_Values.Fader = 255;
+
+    if (_recording->IsComplete())
+        FinishFrameHashRecording();
+
+    return true;
+}
+
+void EffectManager::FinishFrameHashRecording()
+{
+    bool effectStarted = _recordingEffect != nullptr;
+
+    if (_replaySources)
+        _replaySources->End();
+
+    _replaySources.reset();
+    _recordingEffect.reset();
+
+    {
+        std::lock_guard<std::mutex> guard(_recordingMutex);
+
+        _lastRecording = std::move(_recording);
+        _recordingActive = false;
+    }
+
+    debugI("Frame hash recording finished");
+
+    // The replay has drawn over the display, so the regular effect gets a clean start
+    if (effectStarted)
+        StartEffect();
+}
+
+// IsPlaybackSynced
+//
+// Effects are synchronized if the user asked for it, we know what time it is, and effects actually change. While a
+//   temporary effect is showing, we leave the regular timer in charge.
+
+bool EffectManager::IsPlaybackSynced() const
+{
+    return g_ptrSystem->DeviceConfig().SyncEffects()
+        && NTPTimeClient::HasClockBeenSet()
+        && !IsIntervalEternal()
+        && !_tempEffect
+        && EffectCount() > 0;
+}
+
+// GetSyncedEffectIndex
+//
+// Returns the effect to play in a slot. Slots cycle through the enabled effects in list order, so devices that
+//   have the same effect list pick the same effect, and the effect for the next slot is also the one that
+//   GetNextEffectIndex() returns (which means prefetching keeps working as is).
+
+size_t EffectManager::GetSyncedEffectIndex(uint64_t slot) const
+{
+    bool playAll = _bPlayAll || !AreEffectsEnabled();
+    size_t candidateCount = playAll
+        ? EffectCount()
+        : std::count_if(_vEffects.begin(), _vEffects.end(), [](const auto& entry) { return entry.IsEnabled(); });
+
+    size_t candidate = slot % candidateCount;
+
+    for (size_t i = 0; i < EffectCount(); i++)
+    {
+        if ((playAll || _vEffects[i].IsEnabled()) && candidate-- == 0)
+            return i;
+    }
+
+    return 0;
+}
+
+// CheckSyncedEffectTimer
+//
+// Divides wall clock time into slots of one effect interval, counted from the Unix epoch. Whenever a new slot
+//   starts, we switch to the effect for that slot and seed FastLED's random number generator from the slot number,
+//   so every device in sync starts the same effect at the same moment and with the same random8()/random16()
+//   sequence. Arduino's random() is left on the hardware RNG, so what effects draw from that differs per device.
+//   Effect maximum times are ignored in this mode, as they would make devices run out of step.
+
+void EffectManager::CheckSyncedEffectTimer()
+{
+    timeval tv;
+    gettimeofday(&tv, nullptr);
+
+    uint64_t epochMs = (uint64_t) tv.tv_sec * 1000 + tv.tv_usec / 1000;
+    uint64_t slot = epochMs / _effectInterval;
+
+    if (slot == _syncSlot)
+        return;
+
+    _syncSlot = slot;
+    _iCurrentEffect = GetSyncedEffectIndex(slot);
+
+    // We don't call randomSeed(): any non-zero seed would switch Arduino's random() from the hardware RNG to a
+    //   software PRNG for good, for everything on the device that uses it.
+    uint32_t seed = esp_rom_crc32_le(0, (const uint8_t *) &slot, sizeof(slot));
+    random16_set_seed(seed & 0xFFFF);
+
+    // Constructors and Init() functions use random numbers too, so the effect is recreated from its configuration
+    //   now that the generator is seeded, even if it happens to be loaded already. Prefetching is skipped while
+    //   effects are synchronized, but the web server may have loaded the effect, or it may be the one that's playing.
+    {
+        std::lock_guard<std::mutex> guard(_effectLoadMutex);
+
+        // Our own reference to the effect that's playing would keep the entry from unloading it; StartEffect() sets
+        //   a new one right after
+        _currentEffect.reset();
+        _vEffects[_iCurrentEffect].Unload();
+    }
+
+    StartEffect();
+
+    // If we join halfway through a slot, the effect is treated as if it had started when the slot did
+    _effectStartTime = millis() - (uint)(epochMs % _effectInterval);
+
+    SaveCurrentEffectIndex();
+
+    INFORM_EVENT_LISTENERS(_effectEventListeners, IEffectEventListener::OnCurrentEffectChanged, _iCurrentEffect);
+}
+
+// EffectPrefetchTaskEntry
+//
+// Sleeps until the EffectManager asks for the next effect to be prepared, and then unpacks and constructs it
+//   while the current effect is still playing on the other core.
+
+void IRAM_ATTR EffectPrefetchTaskEntry(void *)
+{
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        if (g_ptrSystem->HasEffectManager())
+            g_ptrSystem->EffectManager().PrefetchEffect();
+    }
+}
+
 bool EffectManager::ShowVU(bool bShow)
 {
     auto& deviceConfig = g_ptrSystem->DeviceConfig();
@@ -354,7 +880,8 @@ bool EffectManager::ShowVU(bool bShow)
 
 bool EffectManager::IsVUVisible() const
 {
-    return g_ptrSystem->DeviceConfig().ShowVUMeter() && GetCurrentEffect().CanDisplayVUMeter();
+    // The remote control task asks too, so this goes by what the draw task cached for the effect that's showing
+    return g_ptrSystem->DeviceConfig().ShowVUMeter() && _currentCanDisplayVUMeter;
 }
 
 
@@ -29,6 +29,7 @@
 //---------------------------------------------------------------------------
 
 #include "effectsupport.h"
+#include "effectstore.h"
 
 // Include the effect classes we'll need later
 
@@ -95,6 +96,7 @@
     #include "effects/matrix/PatternRadar.h"
     #include "effects/matrix/PatternPongClock.h"
     #include "effects/matrix/PatternBounce.h"
+    #include "effects/matrix/PatternFlock.h"
     #include "effects/matrix/PatternMandala.h"
     #include "effects/matrix/PatternSpin.h"
     #include "effects/matrix/PatternMisc.h"
@@ -291,6 +293,7 @@ void LoadEffectFactories()
 
         ADD_EFFECT(EFFECT_MATRIX_PULSAR,            PatternPulsar);
         ADD_EFFECT(EFFECT_MATRIX_BOUNCE,            PatternBounce);
+        ADD_EFFECT(EFFECT_MATRIX_FLOCK,             PatternFlock);
         ADD_EFFECT(EFFECT_MATRIX_WAVE,              PatternWave);
         ADD_EFFECT(EFFECT_MATRIX_SWIRL,             PatternSwirl);
         ADD_EFFECT(EFFECT_MATRIX_SERENDIPITY,       PatternSerendipity);
@@ -561,14 +564,16 @@ void LoadEffectFactories()
     assert(!g_ptrEffectFactories->IsEmpty());
 }
 
-// Load the effects JSON file and check if it's appropriate to use
-std::optional<JsonObjectConst> LoadEffectsJSONFile(JsonDocument& jsonDoc)
+// Load the persisted effect configuration and check if it's appropriate to use. The configuration is read from the
+//   binary effect store; if there is none, we try the JSON effects file that earlier versions wrote. The latter is
+//   replaced by the binary store the first time the configuration is saved.
+std::optional<JsonObjectConst> LoadEffectsConfig(JsonDocument& jsonDoc, EffectConfigStore& effectStore)
 {
     // If the effect set version is defined to 0, we ignore whatever is persisted
     if (EFFECT_SET_VERSION == 0)
         return {};
 
-    if (!LoadJSONFile(EFFECTS_CONFIG_FILE, jsonDoc))
+    if (!effectStore.Load(jsonDoc) && !LoadJSONFile(EFFECTS_CONFIG_FILE, jsonDoc))
         return {};
 
     auto jsonObject = jsonDoc.as<JsonObjectConst>();
@@ -0,0 +1,103 @@
+//+--------------------------------------------------------------------------
+//
+// File:        effectsources.cpp
+//
+// NightDriverStrip - (c) 2026 Plummer's Software LLC.  All Rights Reserved.
+//
+// This file is part of the NightDriver software project.
+//
+//    NightDriver is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    NightDriver is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with Nightdriver.  It is normally found in copying.txt
+//    If not, see <https://www.gnu.org/licenses/>.
+//
+// Description:
+//
+//    Implementations of the live and replay effect sources
+//
+//---------------------------------------------------------------------------
+
+#include "globals.h"
+#include "effectsources.h"
+#include "soundanalyzer.h"
+#include "values.h"
+
+unsigned long EffectSources::Millis() const
+{
+    return millis();
+}
+
+double EffectSources::AppTime() const
+{
+    return g_Values.AppTime.FrameStartTime();
+}
+
+double EffectSources::FrameTime() const
+{
+    return g_Values.AppTime.LastFrameTime();
+}
+
+const EffectSources & EffectSources::Live()
+{
+    static const EffectSources liveSources;
+    return liveSources;
+}
+
+void ReplayEffectSources::Begin()
+{
+    // Arduino's random() is left alone: seeding it would take it off the hardware RNG for good. FastLED's generator
+    //   is put back the way it was in End(), so the replay doesn't leave it on a known sequence either.
+    _savedRandom16Seed = random16_get_seed();
+    random16_set_seed(_seed & 0xFFFF);
+
+    g_Analyzer._replaying = true;
+    _frame = 0;
+    ApplyAudio();
+}
+
+void ReplayEffectSources::NextFrame()
+{
+    _frame++;
+    ApplyAudio();
+}
+
+void ReplayEffectSources::End()
+{
+    random16_set_seed(_savedRandom16Seed);
+    g_Analyzer._replaying = false;
+}
+
+// ApplyAudio
+//
+// Sets the audio variables to a simple script: an overall level that pulses roughly twice a second, with each
+//   band following it at its own phase, so audio-reactive effects have something predictable to respond to.
+
+void ReplayEffectSources::ApplyAudio() const
+{
+    float level = (1.0f + sinf(_frame * _frameMs * 0.0125f)) / 2.0f;
+
+    g_Analyzer._VU          = level;
+    g_Analyzer._PeakVU      = 1.0f;
+    g_Analyzer._MinVU       = 0.0f;
+    g_Analyzer._VURatio     = level * 2.0f;
+    g_Analyzer._VURatioFade = level * 2.0f;
+
+    #if ENABLE_AUDIO
+        for (int iBand = 0; iBand < NUM_BANDS; iBand++)
+        {
+            float bandLevel = (1.0f + sinf(_frame * _frameMs * 0.0125f + iBand * 0.4f)) / 2.0f;
+
+            g_Analyzer._peak1Decay[iBand] = bandLevel;
+            g_Analyzer._peak2Decay[iBand] = bandLevel;
+        }
+    #endif
+}
@@ -0,0 +1,434 @@
+//+--------------------------------------------------------------------------
+//
+// File:        effectstore.cpp
+//
+// NightDriverStrip - (c) 2026 Plummer's Software LLC.  All Rights Reserved.
+//
+// This file is part of the NightDriver software project.
+//
+//    NightDriver is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    NightDriver is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with Nightdriver.  It is normally found in copying.txt
+//    If not, see <https://www.gnu.org/licenses/>.
+//
+// Description:
+//
+//    Implementation of the binary effect configuration store
+//
+//---------------------------------------------------------------------------
+
+#include <FS.h>
+#include <SPIFFS.h>
+#include <esp_rom_crc.h>
+
+#include "globals.h"
+#include "systemcontainer.h"
+#include "effectstore.h"
+
+// The store file starts with this header...
+
+struct EffectStoreFileHeader
+{
+    uint32_t magic;
+    uint16_t format;
+    uint16_t reserved;
+};
+
+// ...followed by any number of records, each of which is this header followed by 'length' bytes of MessagePack
+
+struct EffectStoreRecordHeader
+{
+    uint32_t magic;
+    uint8_t  type;
+    uint8_t  reserved;
+    uint16_t slot;              // Index in the effect list, for effect records
+    uint32_t sequence;          // Increases with every record written, so later records supersede earlier ones
+    uint32_t length;
+    uint32_t crc;               // CRC32 of the payload
+};
+
+enum class EffectStoreRecordType : uint8_t
+{
+    Manifest = 1,               // Global effect settings and the number of effects
+    Effect   = 2                // Configuration of the effect in one slot of the effect list
+};
+
+static constexpr uint32_t cStoreFileMagic   = 0x5345444E;      // "NDES"
+static constexpr uint32_t cStoreRecordMagic = 0x5245444E;      // "NDER"
+
+// We compact the store once it's grown to this many times the size of the records that are still current
+#define EFFECTS_STORE_COMPACT_FACTOR    3
+
+#define PTY_STORE_EFFECTCOUNT   "cnt"
+
+static uint32_t PayloadCRC(const PackedEffectConfig& payload)
+{
+    return esp_rom_crc32_le(0, payload.data(), payload.size());
+}
+
+static bool WriteRecord(File& file, EffectStoreRecordType type, uint16_t slot, uint32_t sequence, const PackedEffectConfig& payload, uint32_t crc)
+{
+    EffectStoreRecordHeader header = { cStoreRecordMagic, to_value(type), 0, slot, sequence, (uint32_t) payload.size(), crc };
+
+    return file.write((const uint8_t *) &header, sizeof(header)) == sizeof(header)
+        && file.write(payload.data(), payload.size()) == payload.size();
+}
+
+bool EffectConfigStore::Load(JsonDocument& jsonDoc)
+{
+    _inSync = false;
+
+    // If we were interrupted between removing the old store and renaming its replacement, only the latter is left
+    if (!SPIFFS.exists(EFFECTS_STORE_FILE) && SPIFFS.exists(EFFECTS_STORE_TEMP_FILE))
+        SPIFFS.rename(EFFECTS_STORE_TEMP_FILE, EFFECTS_STORE_FILE);
+
+    File file = SPIFFS.open(EFFECTS_STORE_FILE);
+    if (!file)
+        return false;
+
+    debugI("Attempting to read effect store %s", EFFECTS_STORE_FILE);
+
+    EffectStoreFileHeader fileHeader;
+    if (file.read((uint8_t *) &fileHeader, sizeof(fileHeader)) != sizeof(fileHeader)
+        || fileHeader.magic != cStoreFileMagic
+        || fileHeader.format != EFFECTS_STORE_FORMAT)
+    {
+        debugW("Ignoring effect store %s with unknown format", EFFECTS_STORE_FILE);
+        file.close();
+        return false;
+    }
+
+    // Scan the records, remembering where the latest intact copy of the manifest and every effect slot is
+
+    struct RecordLocation
+    {
+        size_t   offset = 0;
+        uint32_t length = 0;
+        uint32_t crc    = 0;
+    };
+
+    RecordLocation manifestLocation;
+    std::vector<RecordLocation> slotLocations;
+    PackedEffectConfig payload;
+
+    size_t fileSize = file.size();
+    size_t offset = sizeof(fileHeader);
+    uint32_t lastSequence = 0;
+
+    while (offset + sizeof(EffectStoreRecordHeader) <= fileSize)
+    {
+        EffectStoreRecordHeader header;
+
+        if (file.read((uint8_t *) &header, sizeof(header)) != sizeof(header)
+            || header.magic != cStoreRecordMagic
+            || header.sequence <= lastSequence
+            || header.length > fileSize - offset - sizeof(header))
+        {
+            break;
+        }
+
+        payload.resize(header.length);
+
+        if (file.read(payload.data(), header.length) != header.length || PayloadCRC(payload) != header.crc)
+        {
+            debugW("Damaged record found at offset %zu of effect store, ignoring the rest", offset);
+            break;
+        }
+
+        RecordLocation location = { offset + sizeof(header), header.length, header.crc };
+
+        if (header.type == to_value(EffectStoreRecordType::Manifest))
+        {
+            manifestLocation = location;
+        }
+        else if (header.type == to_value(EffectStoreRecordType::Effect))
+        {
+            if (header.slot >= slotLocations.size())
+                slotLocations.resize(header.slot + 1);
+
+            slotLocations[header.slot] = location;
+        }
+
+        lastSequence = header.sequence;
+        offset += sizeof(header) + header.length;
+    }
+
+    // A store without a manifest is no store at all
+    if (manifestLocation.length == 0)
+    {
+        debugW("No manifest found in effect store %s", EFFECTS_STORE_FILE);
+        file.close();
+        return false;
+    }
+
+    payload.resize(manifestLocation.length);
+    file.seek(manifestLocation.offset);
+
+    if (file.read(payload.data(), payload.size()) != payload.size()
+        || deserializeMsgPack(jsonDoc, payload.data(), payload.size()))
+    {
+        debugW("Could not unpack manifest of effect store %s", EFFECTS_STORE_FILE);
+        file.close();
+        return false;
+    }
+
+    size_t effectCount = jsonDoc[PTY_STORE_EFFECTCOUNT];
+    jsonDoc.remove(PTY_STORE_EFFECTCOUNT);
+
+    if (slotLocations.size() < effectCount)
+    {
+        debugW("Effect store %s is missing effects", EFFECTS_STORE_FILE);
+        file.close();
+        return false;
+    }
+
+    // Now unpack the effects into the same array SerializeToJSON() would have produced
+
+    JsonArray effectsArray = jsonDoc["efs"].to<JsonArray>();
+    auto effectDoc = CreateJsonDocument();
+    size_t liveSize = sizeof(fileHeader) + sizeof(EffectStoreRecordHeader) + manifestLocation.length;
+
+    _slotCRCs.resize(effectCount);
+
+    for (size_t i = 0; i < effectCount; i++)
+    {
+        auto& location = slotLocations[i];
+
+        payload.resize(location.length);
+        file.seek(location.offset);
+
+        if (location.length == 0
+            || file.read(payload.data(), payload.size()) != payload.size()
+            || deserializeMsgPack(effectDoc, payload.data(), payload.size()))
+        {
+            debugW("Could not read effect %zu from effect store %s", i, EFFECTS_STORE_FILE);
+            file.close();
+            return false;
+        }
+
+        effectsArray.add(effectDoc.as<JsonObjectConst>());
+
+        _slotCRCs[i] = location.crc;
+        liveSize += sizeof(EffectStoreRecordHeader) + location.length;
+    }
+
+    file.close();
+
+    if (jsonDoc.overflowed())
+    {
+        debugE("Out of memory reading effect store %s", EFFECTS_STORE_FILE);
+        return false;
+    }
+
+    _manifestCRC = manifestLocation.crc;
+    _nextSequence = lastSequence + 1;
+    _fileSize = offset;
+    _liveSize = liveSize;
+
+    // Anything we append after a damaged tail would never be read back, so in that case the next save rewrites the file
+    _inSync = offset == fileSize;
+
+    debugI("Read %zu effects from effect store %s", effectCount, EFFECTS_STORE_FILE);
+
+    return true;
+}
+
+bool EffectConfigStore::Save(const EffectManager& effectManager)
+{
+    std::vector<PackedEffectConfig> effectConfigs;
+
+    if (!effectManager.PackEffectConfigs(effectConfigs))
+    {
+        debugE("Could not pack effect configurations, skipping write to %s!", EFFECTS_STORE_FILE);
+        return false;
+    }
+
+    auto manifestDoc = CreateJsonDocument();
+
+    manifestDoc[PTY_VERSION]            = JSON_FORMAT_VERSION;
+    manifestDoc["ivl"]                  = effectManager.GetInterval();
+    manifestDoc[PTY_PROJECT]            = PROJECT_NAME;
+    manifestDoc[PTY_EFFECTSETVER]       = effectManager.GetEffectSetVersion();
+    manifestDoc[PTY_STORE_EFFECTCOUNT]  = effectConfigs.size();
+
+    PackedEffectConfig manifest(measureMsgPack(manifestDoc));
+    serializeMsgPack(manifestDoc, manifest.data(), manifest.size());
+
+    // If the effect list changed shape, we don't know what's in the file or the file has grown too long, we write
+    //   a fresh copy; otherwise we append only what changed. If appending fails we also fall back to a fresh copy.
+    bool compact = !_inSync
+                   || effectConfigs.size() != _slotCRCs.size()
+                   || _fileSize > EFFECTS_STORE_COMPACT_FACTOR * _liveSize;
+
+    if (!compact && AppendRecords(manifest, effectConfigs))
+        return true;
+
+    return WriteFile(manifest, effectConfigs);
+}
+
+bool EffectConfigStore::AppendRecords(const PackedEffectConfig& manifest, const std::vector<PackedEffectConfig>& effectConfigs)
+{
+    uint32_t manifestCRC = PayloadCRC(manifest);
+    std::vector<uint32_t> effectCRCs(effectConfigs.size());
+    bool anyChanges = manifestCRC != _manifestCRC;
+
+    for (size_t i = 0; i < effectConfigs.size(); i++)
+    {
+        effectCRCs[i] = PayloadCRC(effectConfigs[i]);
+        anyChanges |= effectCRCs[i] != _slotCRCs[i];
+    }
+
+    if (!anyChanges)
+    {
+        debugV("Effect configuration unchanged, nothing to write to %s", EFFECTS_STORE_FILE);
+        return true;
+    }
+
+    File file = SPIFFS.open(EFFECTS_STORE_FILE, FILE_APPEND);
+
+    if (!file)
+    {
+        debugE("Unable to open effect store %s for appending!", EFFECTS_STORE_FILE);
+        _inSync = false;
+        return false;
+    }
+
+    size_t recordCount = 0;
+    size_t fileSizeBefore = _fileSize;
+    bool success = true;
+
+    if (manifestCRC != _manifestCRC)
+    {
+        success = WriteRecord(file, EffectStoreRecordType::Manifest, 0, _nextSequence++, manifest, manifestCRC);
+
+        if (success)
+        {
+            _manifestCRC = manifestCRC;
+            _fileSize += sizeof(EffectStoreRecordHeader) + manifest.size();
+            recordCount++;
+        }
+    }
+
+    for (size_t i = 0; success && i < effectConfigs.size(); i++)
+    {
+        if (effectCRCs[i] == _slotCRCs[i])
+            continue;
+
+        success = WriteRecord(file, EffectStoreRecordType::Effect, i, _nextSequence++, effectConfigs[i], effectCRCs[i]);
+
+        if (success)
+        {
+            _slotCRCs[i] = effectCRCs[i];
+            _fileSize += sizeof(EffectStoreRecordHeader) + effectConfigs[i].size();
+            recordCount++;
+        }
+    }
+
+    file.flush();
+    file.close();
+
+    _recordsWritten += recordCount;
+
+    if (!success)
+    {
+        debugE("Unable to append to effect store %s!", EFFECTS_STORE_FILE);
+        _inSync = false;
+        return false;
+    }
+
+    // The superseded records are still in the file; we just add up what's current to know when to compact
+    _liveSize = sizeof(EffectStoreFileHeader) + sizeof(EffectStoreRecordHeader) + manifest.size();
+    for (const auto& effectConfig : effectConfigs)
+        _liveSize += sizeof(EffectStoreRecordHeader) + effectConfig.size();
+
+    debugI("Appended %zu records to effect store %s", recordCount, EFFECTS_STORE_FILE);
+
+    g_ptrSystem->JSONWriter().CountFileWrite(_fileSize - fileSizeBefore);
+
+    return true;
+}
+
+bool EffectConfigStore::WriteFile(const PackedEffectConfig& manifest, const std::vector<PackedEffectConfig>& effectConfigs)
+{
+    _inSync = false;
+
+    File file = SPIFFS.open(EFFECTS_STORE_TEMP_FILE, FILE_WRITE);
+
+    if (!file)
+    {
+        debugE("Unable to open file %s to write effect store!", EFFECTS_STORE_TEMP_FILE);
+        return false;
+    }
+
+    EffectStoreFileHeader fileHeader = { cStoreFileMagic, EFFECTS_STORE_FORMAT, 0 };
+
+    std::vector<uint32_t> slotCRCs(effectConfigs.size());
+    uint32_t manifestCRC = PayloadCRC(manifest);
+
+    bool success = file.write((const uint8_t *) &fileHeader, sizeof(fileHeader)) == sizeof(fileHeader)
+                   && WriteRecord(file, EffectStoreRecordType::Manifest, 0, _nextSequence++, manifest, manifestCRC);
+    size_t fileSize = sizeof(fileHeader) + sizeof(EffectStoreRecordHeader) + manifest.size();
+
+    for (size_t i = 0; success && i < effectConfigs.size(); i++)
+    {
+        slotCRCs[i] = PayloadCRC(effectConfigs[i]);
+        success = WriteRecord(file, EffectStoreRecordType::Effect, i, _nextSequence++, effectConfigs[i], slotCRCs[i]);
+        fileSize += sizeof(EffectStoreRecordHeader) + effectConfigs[i].size();
+    }
+
+    file.flush();
+    file.close();
+
+    if (!success)
+    {
+        debugE("Unable to write effect store to %s!", EFFECTS_STORE_TEMP_FILE);
+        SPIFFS.remove(EFFECTS_STORE_TEMP_FILE);
+        return false;
+    }
+
+    // SPIFFS can't rename over an existing file, so the old store has to go first. Load() knows how to
+    //   recover if we don't make it to the rename.
+    SPIFFS.remove(EFFECTS_STORE_FILE);
+
+    if (!SPIFFS.rename(EFFECTS_STORE_TEMP_FILE, EFFECTS_STORE_FILE))
+    {
+        debugE("Unable to rename %s to %s!", EFFECTS_STORE_TEMP_FILE, EFFECTS_STORE_FILE);
+        return false;
+    }
+
+    // Now that the binary store is in place, a JSON effects file from an earlier version is no longer needed
+    if (SPIFFS.exists(EFFECTS_CONFIG_FILE))
+        SPIFFS.remove(EFFECTS_CONFIG_FILE);
+
+    _slotCRCs = std::move(slotCRCs);
+    _manifestCRC = manifestCRC;
+    _fileSize = fileSize;
+    _liveSize = fileSize;
+    _inSync = true;
+
+    _recordsWritten += effectConfigs.size() + 1;
+    _compactions++;
+
+    g_ptrSystem->JSONWriter().CountFileWrite(fileSize);
+
+    debugI("Wrote %zu effects to effect store %s (%zu bytes)", effectConfigs.size(), EFFECTS_STORE_FILE, fileSize);
+
+    return true;
+}
+
+void EffectConfigStore::Remove()
+{
+    SPIFFS.remove(EFFECTS_STORE_FILE);
+    SPIFFS.remove(EFFECTS_STORE_TEMP_FILE);
+
+    _inSync = false;
+}
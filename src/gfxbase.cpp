@@ -264,6 +264,17 @@ GFXBase::GFXBase(int w, int h) : Adafruit_GFX(w, h),
         FillGetNoise();
     #endif
 
+    #if HIGH_PRECISION_FRAMEBUFFER
+        debugV("Allocating high precision framebuffer fractions");
+        _ledFractions = make_unique_psram_array<CRGB>(_width * _height);
+        memset(_ledFractions.get(), 0, sizeof(CRGB) * _width * _height);
+    #endif
+
+    #if TRACK_DIRTY_REGIONS
+        debugV("Allocating last frame copy for dirty region tracking");
+        _lastFrame = make_unique_psram_array<CRGB>(_width * _height);
+    #endif
+
     debugV("Setting up palette");
     loadPalette(0);
     ResetOscillators();
@@ -0,0 +1,272 @@
+//+--------------------------------------------------------------------------
+//
+// File:        httpfetcher.cpp
+//
+// NightDriverStrip - (c) 2026 Plummer's Software LLC.  All Rights Reserved.
+//
+// This file is part of the NightDriver software project.
+//
+//    NightDriver is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    NightDriver is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with Nightdriver.  It is normally found in copying.txt
+//    If not, see <https://www.gnu.org/licenses/>.
+//
+// Description:
+//
+//    Implementation of the asynchronous HTTP fetch service
+//
+//---------------------------------------------------------------------------
+
+#include "globals.h"
+
+#if ENABLE_WIFI
+
+#include <algorithm>
+#include <WiFi.h>
+
+#include "systemcontainer.h"
+#include "httpfetcher.h"
+#include "jsonserializer.h"
+
+HTTPFetcher::HTTPFetcher()
+{
+    _requestsAvailable = xSemaphoreCreateCounting(UINT16_MAX, 0);
+    if (!_requestsAvailable)
+        throw std::runtime_error("Unable to create HTTP fetch semaphore");
+}
+
+HTTPFetcher::~HTTPFetcher()
+{
+    vSemaphoreDelete(_requestsAvailable);
+}
+
+// GetCached
+//
+// Looks for a cached response to the request that is no older than it allows. Must be called with _queueMutex held.
+
+bool HTTPFetcher::GetCached(const Request& request, HTTPResponse& response, std::vector<uint8_t>& packedDocument)
+{
+    if (!request.maxAgeMs)
+        return false;
+
+    auto entry = _cache.find(request.url);
+    if (entry == _cache.end() || millis() - entry->second.fetchedMs > request.maxAgeMs)
+        return false;
+
+    // Plain and JSON fetches don't share their cached responses
+    if (entry->second.isJSON != !!request.pFilter)
+        return false;
+
+    response = entry->second.response;
+    response.fromCache = true;
+    packedDocument = entry->second.packedDocument;
+    return true;
+}
+
+// Queue
+//
+// Hands a request to the workers, or completes it right away if we have a recent enough response cached
+
+void HTTPFetcher::Queue(std::shared_ptr<Request> pRequest)
+{
+    HTTPResponse cached;
+    std::vector<uint8_t> packedDocument;
+    bool isCached;
+
+    {
+        std::lock_guard<std::mutex> guard(_queueMutex);
+
+        isCached = GetCached(*pRequest, cached, packedDocument);
+        if (!isCached)
+            _queue.push_back(pRequest);
+    }
+
+    if (!isCached)
+    {
+        std::call_once(_workersStarted, [] { g_ptrSystem->TaskManager().StartHTTPFetchThreads(); });
+        xSemaphoreGive(_requestsAvailable);
+        return;
+    }
+
+    _cacheHits++;
+
+    auto document = CreateJsonDocument();
+    if (pRequest->pFilter)
+        cached.jsonError = deserializeMsgPack(document, packedDocument.data(), packedDocument.size());
+
+    Complete(*pRequest, cached, document);
+}
+
+void HTTPFetcher::Fetch(const String& url, Callback callback, const void * owner, unsigned long maxAgeMs)
+{
+    Queue(std::make_shared<Request>(Request{ url, std::move(callback), nullptr, nullptr, owner, maxAgeMs }));
+}
+
+void HTTPFetcher::FetchJSON(const String& url, const JsonDocument& filter, JSONCallback callback, const void * owner, unsigned long maxAgeMs)
+{
+    Queue(std::make_shared<Request>(Request{ url, nullptr, std::move(callback), std::make_shared<JsonDocument>(filter), owner, maxAgeMs }));
+}
+
+void HTTPFetcher::CancelFetches(const void * owner)
+{
+    // Taking the callback mutex first means that any callback that's running completes before we return
+
+    std::lock_guard<std::recursive_mutex> callbackGuard(_callbackMutex);
+    std::lock_guard<std::mutex> queueGuard(_queueMutex);
+
+    _queue.erase(std::remove_if(_queue.begin(), _queue.end(), [owner](const auto& pRequest) { return pRequest->owner == owner; }), _queue.end());
+
+    for (auto& pRequest : _active)
+        if (pRequest->owner == owner)
+            pRequest->canceled = true;
+}
+
+// Complete
+//
+// Hands the outcome of a request to its callback, unless the request was canceled in the meantime
+
+void HTTPFetcher::Complete(Request& request, const HTTPResponse& response, JsonDocument& document)
+{
+    std::lock_guard<std::recursive_mutex> guard(_callbackMutex);
+
+    if (request.canceled)
+        return;
+
+    if (request.jsonCallback)
+        request.jsonCallback(response, document);
+    else if (request.callback)
+        request.callback(response);
+}
+
+// Execute
+//
+// Performs one request on the worker's client
+
+void HTTPFetcher::Execute(HTTPClient& http, Request& request)
+{
+    HTTPResponse response;
+    std::vector<uint8_t> packedDocument;
+    auto document = CreateJsonDocument();
+
+    _fetches++;
+
+    // Another worker may have fetched the same URL while this request was waiting in the queue
+
+    bool isCached;
+    {
+        std::lock_guard<std::mutex> guard(_queueMutex);
+        isCached = GetCached(request, response, packedDocument);
+    }
+
+    if (isCached)
+    {
+        _cacheHits++;
+        if (request.pFilter)
+            response.jsonError = deserializeMsgPack(document, packedDocument.data(), packedDocument.size());
+    }
+    else if (!WiFi.isConnected())
+    {
+        response.statusCode = HTTPC_ERROR_NOT_CONNECTED;
+    }
+    else
+    {
+        // JSON is parsed as it's read from the connection, which the parser can only do if the server doesn't use
+        // chunked transfer encoding. Asking for HTTP/1.0 makes sure of that, at the cost of the kept-alive connection.
+
+        http.useHTTP10(!!request.pFilter);
+
+        if (!http.begin(request.url))
+        {
+            response.statusCode = HTTPC_ERROR_CONNECTION_REFUSED;
+        }
+        else
+        {
+            response.statusCode = http.GET();
+            if (response.statusCode == HTTP_CODE_OK)
+            {
+                if (request.pFilter)
+                    response.jsonError = deserializeJson(document, http.getStream(), DeserializationOption::Filter(*request.pFilter));
+                else
+                    response.body = http.getString();
+            }
+
+            http.end();
+        }
+    }
+
+    if (!response.IsOK())
+    {
+        _failures++;
+        debugW("HTTP GET of %s failed: %s", request.url.c_str(), response.ErrorString().c_str());
+    }
+    else if (request.maxAgeMs && !response.fromCache)
+    {
+        if (request.pFilter)
+        {
+            packedDocument.resize(measureMsgPack(document));
+            serializeMsgPack(document, packedDocument.data(), packedDocument.size());
+        }
+
+        std::lock_guard<std::mutex> guard(_queueMutex);
+
+        if (_cache.size() >= kMaxCacheEntries)
+            _cache.clear();
+
+        _cache[request.url] = { response, std::move(packedDocument), !!request.pFilter, millis() };
+    }
+
+    Complete(request, response, document);
+}
+
+void HTTPFetcher::WorkerLoop()
+{
+    // Each worker has a client of its own, which keeps its connection open between requests to the same server
+
+    HTTPClient http;
+    http.setReuse(true);
+    http.setConnectTimeout(HTTP_FETCH_CONNECT_TIMEOUT);
+    http.setTimeout(HTTP_FETCH_TIMEOUT);
+
+    for (;;)
+    {
+        xSemaphoreTake(_requestsAvailable, portMAX_DELAY);
+
+        std::shared_ptr<Request> pRequest;
+        {
+            std::lock_guard<std::mutex> guard(_queueMutex);
+
+            // Canceled requests leave their semaphore count behind, so the queue may be empty
+            if (_queue.empty())
+                continue;
+
+            pRequest = _queue.front();
+            _queue.pop_front();
+            _active.push_back(pRequest);
+        }
+
+        Execute(http, *pRequest);
+
+        std::lock_guard<std::mutex> guard(_queueMutex);
+        _active.erase(std::find(_active.begin(), _active.end(), pRequest));
+    }
+}
+
+// HTTPFetchTaskEntry
+//
+// Entry point for the HTTP fetch worker tasks
+
+void IRAM_ATTR HTTPFetchTaskEntry(void *)
+{
+    g_ptrSystem->HTTPFetcher().WorkerLoop();
+}
+
+#endif // ENABLE_WIFI
@@ -29,6 +29,9 @@
 
 #include <FS.h>
 #include <SPIFFS.h>
+#include <map>
+#include <mutex>
+#include <esp_rom_crc.h>
 
 #include "globals.h"
 #include "systemcontainer.h"
@@ -39,10 +42,110 @@ bool BoolFromText(const String& text)
     return text == "true" || strtol(text.c_str(), nullptr, 10);
 }
 
+// CRCs of the file contents we last read or wrote, so we can tell if a write would change anything. Files are
+//   mostly written by the JSON writer task, but removed by whichever task handles the reset, hence the mutex.
+static std::map<String, uint32_t> l_FileContentCRCs;
+static std::mutex l_FileContentCRCsMutex;
+
+static void SetFileContentCRC(const String & fileName, uint32_t crc)
+{
+    std::lock_guard<std::mutex> guard(l_FileContentCRCsMutex);
+    l_FileContentCRCs[fileName] = crc;
+}
+
+static void ForgetFileContentCRC(const String & fileName)
+{
+    std::lock_guard<std::mutex> guard(l_FileContentCRCsMutex);
+    l_FileContentCRCs.erase(fileName);
+}
+
+static bool IsFileContentCRC(const String & fileName, uint32_t crc)
+{
+    std::lock_guard<std::mutex> guard(l_FileContentCRCsMutex);
+    auto crcEntry = l_FileContentCRCs.find(fileName);
+    return crcEntry != l_FileContentCRCs.end() && crcEntry->second == crc;
+}
+
+static String TempFileName(const String & fileName)
+{
+    return fileName + ".tmp";
+}
+
+// If a file replacement was interrupted after the old file was removed, the new contents are still in the temp file
+void RecoverReplacedFile(const String & fileName)
+{
+    String tempName = TempFileName(fileName);
+
+    if (!SPIFFS.exists(fileName) && SPIFFS.exists(tempName))
+    {
+        debugW("Recovering %s from %s", fileName.c_str(), tempName.c_str());
+        SPIFFS.rename(tempName, fileName);
+    }
+}
+
+bool ReplaceFileContents(const String & fileName, const uint8_t * pData, size_t length)
+{
+    uint32_t crc = esp_rom_crc32_le(0, pData, length);
+    bool haveWriter = g_ptrSystem->HasJSONWriter();
+
+    if (IsFileContentCRC(fileName, crc) && SPIFFS.exists(fileName))
+    {
+        debugV("Contents of %s unchanged, skipping write", fileName.c_str());
+
+        if (haveWriter)
+            g_ptrSystem->JSONWriter().CountUnchangedFile();
+
+        return true;
+    }
+
+    String tempName = TempFileName(fileName);
+    File file = SPIFFS.open(tempName, FILE_WRITE);
+
+    if (!file)
+    {
+        debugE("Unable to open file %s for writing!", tempName.c_str());
+        return false;
+    }
+
+    size_t bytesWritten = file.write(pData, length);
+
+    file.flush();
+    file.close();
+
+    if (bytesWritten != length)
+    {
+        debugE("Unable to write to file %s!", tempName.c_str());
+        SPIFFS.remove(tempName);
+        return false;
+    }
+
+    // SPIFFS can't rename over an existing file, so the old one has to go first. RecoverReplacedFile() takes
+    //   care of things if we don't make it to the rename.
+    SPIFFS.remove(fileName);
+
+    if (!SPIFFS.rename(tempName, fileName))
+    {
+        debugE("Unable to rename %s to %s!", tempName.c_str(), fileName.c_str());
+        ForgetFileContentCRC(fileName);
+        return false;
+    }
+
+    debugI("Number of bytes written to file %s: %zu", fileName.c_str(), bytesWritten);
+
+    SetFileContentCRC(fileName, crc);
+
+    if (haveWriter)
+        g_ptrSystem->JSONWriter().CountFileWrite(bytesWritten);
+
+    return true;
+}
+
 bool LoadJSONFile(const String & fileName, JsonDocument& jsonDoc)
 {
     bool jsonReadSuccessful = false;
 
+    RecoverReplacedFile(fileName);
+
     File file = SPIFFS.open(fileName);
 
     if (file)
@@ -51,7 +154,12 @@ bool LoadJSONFile(const String & fileName, JsonDocument& jsonDoc)
         {
             debugI("Attempting to read JSON file %s", fileName.c_str());
 
-            DeserializationError error = deserializeJson(jsonDoc, file);
+            // Read the whole file first, so we know what's in it when the time comes to write it again
+            std::vector<uint8_t, psram_allocator<uint8_t>> buffer(file.size());
+            buffer.resize(file.read(buffer.data(), buffer.size()));
+            SetFileContentCRC(fileName, esp_rom_crc32_le(0, buffer.data(), buffer.size()));
+
+            DeserializationError error = deserializeJson(jsonDoc, buffer.data(), buffer.size());
 
             if (error == DeserializationError::NoMemory)
             {
@@ -84,26 +192,12 @@ bool SaveToJSONFile(const String & fileName, IJSONSerializable& object)
         return false;
     }
 
-    SPIFFS.remove(fileName);
-
-    File file = SPIFFS.open(fileName, FILE_WRITE);
+    std::vector<uint8_t, psram_allocator<uint8_t>> buffer(measureJson(jsonDoc));
+    serializeJson(jsonDoc, buffer.data(), buffer.size());
 
-    if (!file)
-    {
-        debugE("Unable to open file %s to write JSON!", fileName.c_str());
-        return false;
-    }
-
-    size_t bytesWritten = serializeJson(jsonDoc, file);
-    debugI("Number of bytes written to JSON file %s: %zu", fileName.c_str(), bytesWritten);
-
-    file.flush();
-    file.close();
-
-    if (bytesWritten == 0)
+    if (!ReplaceFileContents(fileName, buffer.data(), buffer.size()))
     {
         debugE("Unable to write JSON to file %s!", fileName.c_str());
-        SPIFFS.remove(fileName);
         return false;
     }
 
@@ -112,6 +206,9 @@ bool SaveToJSONFile(const String & fileName, IJSONSerializable& object)
 
 bool RemoveJSONFile(const String & fileName)
 {
+    ForgetFileContentCRC(fileName);
+    SPIFFS.remove(TempFileName(fileName));
+
     return SPIFFS.remove(fileName);
 }
 
@@ -129,7 +226,15 @@ void JSONWriter::FlagWriter(size_t index)
         return;
 
     writers[index].flag.store(true);
-    latestFlagMs.store(millis());
+
+    auto now = millis();
+    latestFlagMs.store(now);
+
+    // Remember when the first of the flags that are now pending was raised, so we don't postpone writing forever
+    unsigned long noPendingFlags = 0;
+    pendingSinceMs.compare_exchange_strong(noPendingFlags, now);
+
+    statistics.flagsRaised++;
 
     g_ptrSystem->TaskManager().NotifyJSONWriterThread();
 }
@@ -172,7 +277,12 @@ void IRAM_ATTR JSONWriterTaskEntry(void *)
             if (jsonWriter.haltWrites.load())
                 continue;
 
-            unsigned long holdUntil = jsonWriter.latestFlagMs.load() + JSON_WRITER_DELAY;
+            // Every new flag postpones writing a bit, so a burst of changes ends up in one batch. We don't let
+            //   that go on for longer than JSON_WRITER_MAX_DELAY, and we leave at least JSON_WRITER_MIN_INTERVAL
+            //   between batches, so a UI that keeps sending changes doesn't wear out the flash.
+            unsigned long holdUntil = std::min(jsonWriter.latestFlagMs.load() + JSON_WRITER_DELAY,
+                                               jsonWriter.pendingSinceMs.load() + JSON_WRITER_MAX_DELAY);
+            holdUntil = std::max(holdUntil, jsonWriter.latestCommitMs.load() + JSON_WRITER_MIN_INTERVAL);
             unsigned long now = millis();
             if (now >= holdUntil)
                 break;
@@ -180,7 +290,14 @@ void IRAM_ATTR JSONWriterTaskEntry(void *)
             notifyWait = pdMS_TO_TICKS(holdUntil - now);
         }
 
-        for (auto &entry : g_ptrSystem->JSONWriter().writers)
+        auto& jsonWriter = g_ptrSystem->JSONWriter();
+
+        // Flags raised from here on belong to the next batch
+        jsonWriter.pendingSinceMs.store(0);
+        jsonWriter.latestCommitMs.store(millis());
+        jsonWriter.statistics.commits++;
+
+        for (auto &entry : jsonWriter.writers)
         {
             // Unset flag before we do the actual write. This makes that we don't miss another flag raise if it happens while writing
             if (entry.flag.exchange(false))
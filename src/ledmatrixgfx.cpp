@@ -42,6 +42,11 @@ SMLayerBackground<LEDMatrixGFX::SM_RGB, LEDMatrixGFX::kBackgroundLayerOptions> L
 SMLayerBackground<LEDMatrixGFX::SM_RGB, LEDMatrixGFX::kBackgroundLayerOptions> LEDMatrixGFX::titleLayer(kMatrixWidth, kMatrixHeight);
 SmartMatrixHub75Calc<COLOR_DEPTH, LEDMatrixGFX::kMatrixWidth, LEDMatrixGFX::kMatrixHeight, LEDMatrixGFX::kPanelType, LEDMatrixGFX::kMatrixOptions> LEDMatrixGFX::matrix;
 
+// The caption that is currently rendered on the title layer, so we only redraw it when it changes
+
+static String l_renderedCaption;
+static bool   l_captionRendered = false;
+
 void LEDMatrixGFX::StartMatrix()
 {
     matrix.addLayer(&backgroundLayer);
@@ -102,34 +107,44 @@ void LEDMatrixGFX::PrepareFrame()
             uint8_t brite = (uint8_t)(pMatrix->GetCaptionTransparency() * 255.0);
             debugV("Caption: %d", brite);
 
-            rgb24 chromaKeyColor = rgb24(255, 0, 255);
-            rgb24 shadowColor = rgb24(0, 0, 0);
-            rgb24 titleColor = rgb24(255, 255, 255);
-
-            titleLayer.setChromaKeyColor(chromaKeyColor);
-            titleLayer.setFont(font6x10);
-            titleLayer.fillScreen(chromaKeyColor);
-
             const size_t kCharWidth = 6;
             const size_t kCharHeight = 10;
 
-            const auto caption = pMatrix->GetCaption();
-
+            const auto & caption = pMatrix->GetCaption();
             int y = MATRIX_HEIGHT - 2 - kCharHeight;
-            int w = caption.length() * kCharWidth;
-            int x = (MATRIX_WIDTH / 2) - (w / 2) + 1;
 
-            auto szCaption = caption.c_str();
-            titleLayer.drawString(x - 1, y, shadowColor, szCaption);
-            titleLayer.drawString(x + 1, y, shadowColor, szCaption);
-            titleLayer.drawString(x, y - 1, shadowColor, szCaption);
-            titleLayer.drawString(x, y + 1, shadowColor, szCaption);
-            titleLayer.drawString(x, y, titleColor, szCaption);
+            // The caption is the same for many frames in a row while it fades, so we only render it when the text
+            // actually changes; the title layer keeps showing what we drew last time until we swap it again.
+
+            if (!l_captionRendered || caption != l_renderedCaption)
+            {
+                rgb24 chromaKeyColor = rgb24(255, 0, 255);
+                rgb24 shadowColor = rgb24(0, 0, 0);
+                rgb24 titleColor = rgb24(255, 255, 255);
+
+                titleLayer.setChromaKeyColor(chromaKeyColor);
+                titleLayer.setFont(font6x10);
+                titleLayer.fillScreen(chromaKeyColor);
+
+                int w = caption.length() * kCharWidth;
+                int x = (MATRIX_WIDTH / 2) - (w / 2) + 1;
+
+                auto szCaption = caption.c_str();
+                titleLayer.drawString(x - 1, y, shadowColor, szCaption);
+                titleLayer.drawString(x + 1, y, shadowColor, szCaption);
+                titleLayer.drawString(x, y - 1, shadowColor, szCaption);
+                titleLayer.drawString(x, y + 1, shadowColor, szCaption);
+                titleLayer.drawString(x, y, titleColor, szCaption);
+
+                titleLayer.swapBuffers(false);
+
+                l_renderedCaption = caption;
+                l_captionRendered = true;
+            }
 
             // We enable the chromakey overlay just for the strip of screen where it appears.  This support is only
             // present in the private fork of SmartMatrix that is linked to the mesmerizer project.
 
-            titleLayer.swapBuffers(false);
             titleLayer.enableChromaKey(true, y, y + kCharHeight);
             titleLayer.setBrightness(brite); // 255 would obscure it entirely
         }
@@ -137,6 +152,7 @@ void LEDMatrixGFX::PrepareFrame()
         {
             titleLayer.enableChromaKey(false);
             titleLayer.setBrightness(0);
+            l_captionRendered = false;
         }
     }
 }
@@ -159,19 +175,12 @@ void LEDMatrixGFX::PostProcessFrame(uint16_t localPixelsDrawn, uint16_t wifiPixe
     if (pMatrix->GetCaptionTransparency() > 0)
         g_Values.MatrixPowerMilliwatts += kCaptionPower;
 
-    const double kMaxPower = g_ptrSystem->DeviceConfig().GetPowerLimit();
-    uint8_t scaledBrightness = std::clamp(kMaxPower / g_Values.MatrixPowerMilliwatts, 0.0, 1.0) * 255;
+    // The limiter drops the brightness immediately if the power goes over the limit, but ramps it back in somewhat slowly to
+    // avoid flicker.  It also anticipates the limit while the power draw is climbing.
 
-    // If the target brightness is lower than current, we drop to it immediately, but if it is higher, we ramp the brightness back in
-    // somewhat slowly to avoid flicker.  We do this by using a weighted average of the current and former brightness.  To avoid
-    // an asymptote near the max, we always increase by at least one step if we're lower than the target.
-
-    constexpr auto kWeightedAverageAmount = 10;
-    if (scaledBrightness <= g_Values.MatrixScaledBrightness)
-        g_Values.MatrixScaledBrightness = scaledBrightness;
-    else
-        g_Values.MatrixScaledBrightness = std::max(g_Values.MatrixScaledBrightness + 1,
-                                                    (( g_Values.MatrixScaledBrightness * (kWeightedAverageAmount-1) ) + scaledBrightness) / kWeightedAverageAmount);
+    static PowerLimiter powerLimiter;
+    powerLimiter.AddFrame(g_Values.MatrixPowerMilliwatts);
+    g_Values.MatrixScaledBrightness = powerLimiter.Brightness(std::max(g_ptrSystem->DeviceConfig().GetPowerLimit(), 0));
 
     // We set ourselves to the lower of the fader value or the brightness value, or the power constrained value,
     // whichever is lowest, so that we can fade between effects without having to change the brightness setting.
@@ -181,9 +190,27 @@ void LEDMatrixGFX::PostProcessFrame(uint16_t localPixelsDrawn, uint16_t wifiPixe
     debugV("MW: %d, Setting Scaled Brightness to: %d", g_Values.MatrixPowerMilliwatts, targetBrightness);
     pMatrix->SetBrightness(targetBrightness);
 
-    MatrixSwapBuffers((wifiPixelsDrawn > 0) || g_ptrSystem->EffectManager().GetCurrentEffect().RequiresDoubleBuffering() || pMatrix->GetCaptionTransparency() > 0.0);
-
     FastLED.countFPS();
+
+    // If the frame didn't change, the front buffer is already showing it. If only the effect needs its last frame back
+    // in the back buffer, we swap without SmartMatrix copying the whole buffer and copy back just what changed.
+
+    const bool bCaption = pMatrix->GetCaptionTransparency() > 0.0;
+    const bool bEffectNeedsCopy = g_ptrSystem->EffectManager().GetCurrentEffect().RequiresDoubleBuffering();
+
+    if (pMatrix->GetDirtyRect().IsEmpty() && wifiPixelsDrawn == 0 && !bCaption)
+        return;
+
+    #if TRACK_DIRTY_REGIONS
+        if (bEffectNeedsCopy && wifiPixelsDrawn == 0 && !bCaption)
+        {
+            MatrixSwapBuffers(false);
+            pMatrix->RestoreDirtyRect((CRGB *)backgroundLayer.getRealBackBuffer());
+            return;
+        }
+    #endif
+
+    MatrixSwapBuffers((wifiPixelsDrawn > 0) || bEffectNeedsCopy || bCaption);
 }
 
 CRGB *LEDMatrixGFX::GetMatrixBackBuffer()
@@ -32,6 +32,39 @@
 #include "ledstripgfx.h"
 #include "systemcontainer.h"
 
+static OutputLUT l_outputLUT;               // Output tables for the brightness of the last frame
+static uint16_t  l_pixelsShown = 0;         // Pixels per channel in the last frame shown
+static uint32_t  l_usShowTime = 0;          // How long the last FastLED.show() took
+
+void LEDStripGFX::ShowOutput(uint16_t count, ColorSums * pSums, bool bRefresh)
+{
+    auto& effectManager = g_ptrSystem->EffectManager();
+
+    for (int i = 0; i < NUM_CHANNELS; i++)
+    {
+        auto pDevice = std::static_pointer_cast<LEDStripGFX>(effectManager.g(i));
+        FastLED[i].setLeds(pDevice->ApplyOutputStage(l_outputLUT, count, pSums), count);
+    }
+
+    auto usStart = micros();
+    if (bRefresh)
+    {
+        for (int i = 0; i < NUM_CHANNELS; i++)
+            FastLED[i].showLeds(255);
+    }
+    else
+    {
+        FastLED.show(255); //Shows the pixels
+    }
+    l_usShowTime = micros() - usStart;
+
+    // Some effects draw through FastLED[] directly, so point the controllers back at the drawing buffers
+    for (int i = 0; i < NUM_CHANNELS; i++)
+        FastLED[i].setLeds(effectManager.g(i)->leds, count);
+
+    l_pixelsShown = count;
+}
+
 void LEDStripGFX::PostProcessFrame(uint16_t localPixelsDrawn, uint16_t wifiPixelsDrawn)
 {
     auto pixelsDrawn = wifiPixelsDrawn > 0 ? wifiPixelsDrawn : localPixelsDrawn;
@@ -51,20 +84,62 @@ void LEDStripGFX::PostProcessFrame(uint16_t localPixelsDrawn, uint16_t wifiPixel
         return;
     }
 
-    auto& effectManager = g_ptrSystem->EffectManager();
+    uint8_t brightness = g_ptrSystem->DeviceConfig().GetBrightness();
 
-    for (int i = 0; i < NUM_CHANNELS; i++)
-    {
-        FastLED[i].setLeds(effectManager.g(i)->leds, pixelsDrawn);
-        fadeLightBy(FastLED[i].leds(), FastLED[i].size(), 255 - g_ptrSystem->DeviceConfig().GetBrightness());
-    }
-    FastLED.show(g_Values.Fader); //Shows the pixels
+    // The power limit is applied to the brightness up front, based on what the previous frames drew; the power
+    // of this frame is then accounted for in the output pass
 
-    g_Values.FPS = FastLED.getFPS();
+    static PowerLimiter powerLimiter;
     #ifdef POWER_LIMIT_MW
-        g_Values.Brite = 100.0 * calculate_max_brightness_for_power_mW(g_ptrSystem->DeviceConfig().GetBrightness(), POWER_LIMIT_MW) / 255;
+        brightness = std::min(brightness, powerLimiter.Brightness(POWER_LIMIT_MW));
+    #endif
+
+    // Brightness, fader, gamma and white balance are all applied in one pass through the output tables
+
+    l_outputLUT.Update(scale8(brightness, g_Values.Fader));
+
+    ColorSums sums;
+    ShowOutput(pixelsDrawn, &sums);
+
+    g_Values.FPS = FastLED.getFPS();
+    // Per-channel figures for WS2812-style LEDs at 5V, the same FastLED's power management uses
+    uint32_t unscaledPower = sums.Milliwatts(16 * 5, 11 * 5, 15 * 5, 1 * 5);
+    powerLimiter.AddFrame(unscaledPower);
+
+    g_Values.Brite = 100.0 * brightness / 255;
+    g_Values.Watts = unscaledPower * brightness / 255 / 1000; // 1000 for mw->W
+}
+
+void LEDStripGFX::WaitForNextFrame(int msDelay)
+{
+    #if OUTPUT_DITHER && OUTPUT_REFRESH_RATE > 0
+
+        // Refreshing only makes a difference if the output tables or the framebuffer leave fractions to dither
+        if (l_pixelsShown == 0 || (l_outputLUT.IsIdentity() && !HIGH_PRECISION_FRAMEBUFFER))
+        {
+            delay(msDelay);
+            return;
+        }
+
+        constexpr uint32_t kRefreshInterval = MICROS_PER_SECOND / OUTPUT_REFRESH_RATE;
+
+        const auto usStart = micros();
+        const uint32_t usDelay = msDelay * 1000;
+
+        // Keep sending the last frame for as long as another refresh fits before the next frame is due. Nothing
+        // draws into the LED buffers while we're here, because that happens on this same task.
+
+        while (micros() - usStart + kRefreshInterval + l_usShowTime <= usDelay)
+        {
+            delay(kRefreshInterval / 1000);
+            ShowOutput(l_pixelsShown, nullptr, true);
+        }
+
+        const uint32_t usElapsed = micros() - usStart;
+        if (usElapsed < usDelay)
+            delay((usDelay - usElapsed) / 1000);
+
     #else
-        g_Values.Brite = 100.0 * g_ptrSystem->DeviceConfig().GetBrightness() / 255;
+        delay(msDelay);
     #endif
-    g_Values.Watts = calculate_unscaled_power_mW(effectManager.g()->leds, pixelsDrawn) / 1000; // 1000 for mw->W
 }
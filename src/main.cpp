@@ -382,9 +382,14 @@ void setup()
         //   threads.
         auto & networkReader = g_ptrSystem->SetupNetworkReader();
 
+        // Same goes for the HTTP fetcher; it starts its worker tasks when the first request comes in
+        g_ptrSystem->SetupHTTPFetcher();
+
         #if ENABLE_NTP
-            // Register a network reader to update the device clock at regular intervals
-            networkReader.RegisterReader(UpdateNTPTime, (NTP_DELAY_ERROR_SECONDS) * 1000UL);
+            // Register a network reader to update the device clock at regular intervals. It gets a task of its own
+            //   because waiting for the NTP server's reply can take several seconds. When it doesn't come, the reader
+            //   backs off before it tries again.
+            networkReader.RegisterReaderWithRetry(UpdateNTPTime, (NTP_DELAY_ERROR_SECONDS) * 1000UL, false, { "NTP", ReaderPriority::Low, 0, true });
         #endif
     #endif
 
@@ -533,6 +538,7 @@ void setup()
     // Start things that do not depend on the network
 
     taskManager.StartDrawThread();
+    taskManager.StartEffectPrefetchThread();
     taskManager.StartScreenThread();
     taskManager.StartAudioThread();
     taskManager.StartRemoteThread();
@@ -174,6 +174,11 @@ void onReceiveESPNOW(const uint8_t *macAddr, const uint8_t *data, int dataLen)
         {
              NTPTimeClient::ShowUptime();
         }
+        else if (str.equalsIgnoreCase("readers"))
+        {
+            if (g_ptrSystem->HasNetworkReader())
+                g_ptrSystem->NetworkReader().LogStatistics();
+        }
         else
         {
             debugA("Unknown Command.  Extended Commands:");
@@ -181,6 +186,7 @@ void onReceiveESPNOW(const uint8_t *macAddr, const uint8_t *data, int dataLen)
             debugA("stats               Display buffers, memory, etc");
             debugA("clearsettings       Reset persisted user settings");
             debugA("uptime              Show system uptime, reset reason");
+            debugA("readers             Show network reader timing statistics");
         }
     }
 #endif
@@ -428,7 +434,12 @@ void IRAM_ATTR RemoteLoopEntry(void *)
     }
 
     #if ENABLE_NTP
-        void UpdateNTPTime()
+        // UpdateNTPTime
+        //
+        // Network reader that sets the clock from the NTP server. Returns false if the server didn't come through,
+        // so that the NetworkReader retries it with backoff.
+
+        bool UpdateNTPTime()
         {
             static unsigned long lastUpdate = 0;
 
@@ -438,10 +449,14 @@ void IRAM_ATTR RemoteLoopEntry(void *)
                 if (!NTPTimeClient::HasClockBeenSet() || (millis() - lastUpdate) > ((NTP_DELAY_SECONDS) * 1000))
                 {
                     debugV("Refreshing Time from Server...");
-                    if (NTPTimeClient::UpdateClockFromWeb(&l_Udp))
-                        lastUpdate = millis();
+                    if (!NTPTimeClient::UpdateClockFromWeb(&l_Udp))
+                        return false;
+
+                    lastUpdate = millis();
                 }
             }
+
+            return true;
         }
     #endif
 #endif // ENABLE_WIFI
@@ -723,6 +738,12 @@ bool WriteWiFiConfig(const String& WiFi_ssid, const String& WiFi_password)
         int socket = -1;
         bool wsListenersPresent = false;
         BaseFrameEventListener frameEventListener;
+        uint32_t lastSentVersion = 0;
+        unsigned long lastSentTime = 0;
+
+        // Frames that are the same as the last one sent are skipped, but we do resend at least this often so
+        // that clients that just connected get a picture of a display that isn't changing
+        constexpr auto kMaxResendInterval = 1000;
 
         auto& effectManager = g_ptrSystem->EffectManager();
         #if COLORDATA_WEB_SOCKET_ENABLED
@@ -755,9 +776,14 @@ bool WriteWiFiConfig(const String& WiFi_ssid, const String& WiFi_password)
                 socket = _viewer.CheckForConnection();
 
             auto leds = effectManager.g()->leds;
+            auto contentVersion = effectManager.g()->GetContentVersion();
 
-            if (frameEventListener.CheckAndClearNewFrameAvailable() && leds != nullptr)
+            if (frameEventListener.CheckAndClearNewFrameAvailable() && leds != nullptr
+                && (contentVersion != lastSentVersion || millis() - lastSentTime >= kMaxResendInterval))
             {
+                lastSentVersion = contentVersion;
+                lastSentTime = millis();
+
                 if (socket >= 0)
                 {
                     debugV("Sending color data packet");
@@ -857,75 +883,36 @@ bool WriteWiFiConfig(const String& WiFi_ssid, const String& WiFi_password)
                 continue;
             }
 
-            auto& networkReader = g_ptrSystem->NetworkReader();
-            unsigned long now = millis();
-
-            // Flag entries of which the read interval has passed
-            for (auto& entry : networkReader.readers)
-            {
-                if (entry.canceled.load())
-                    continue;
-
-                auto interval = entry.readInterval.load();
-                unsigned long targetMs = entry.lastReadMs.load() + interval;
-
-                // The last check captures cases where millis() returns bogus data; if the delta between now and lastReadMs is greater
-                //   than the interval then something's up with our timekeeping, so we trigger the reader just to be sure
-                if (interval && (targetMs <= now || (std::max(now, targetMs) - std::min(now, targetMs)) > interval))
-                    entry.flag.store(true);
-
-                // Unset flag before we do the actual read. This makes that we don't miss another flag raise if it happens while reading
-                if (entry.flag.exchange(false))
-                {
-                    entry.reader();
-                    entry.lastReadMs.store(millis());
-                }
-            }
-
-            // We wake up at least once every second
-            unsigned long holdMs = 1000;
-            now = millis();
-
-            // Calculate how long we can sleep. This is determined by the reader that is closest to its interval passing.
-            for (auto& entry : networkReader.readers)
-            {
-                if (entry.canceled.load())
-                    continue;
-
-                auto interval = entry.readInterval.load();
-                auto lastReadMs = entry.lastReadMs.load();
-
-                if (!interval)
-                    continue;
-
-                // If one of the reader intervals passed then we're up for another read cycle right away, so we can stop looking further
-                if (lastReadMs + interval <= now)
-                {
-                    holdMs = 0;
-                    break;
-                }
-                else
-                {
-                    unsigned long entryHoldMs = std::min(interval, interval - (now - lastReadMs));
-                    if (entryHoldMs < holdMs)
-                        holdMs = entryHoldMs;
-                }
-            }
-
-            notifyWait = pdMS_TO_TICKS(holdMs);
+            // Run the readers that are due, and sleep until the next one is or until we're woken up
+            notifyWait = pdMS_TO_TICKS(g_ptrSystem->NetworkReader().RunDueReaders());
         }
     }
 
-    size_t NetworkReader::RegisterReader(const std::function<void()>& reader, unsigned long interval, bool flag)
+    size_t NetworkReader::AddReader(std::function<bool()> reader, unsigned long interval, bool flag, const ReaderOptions& options)
     {
         // Add the reader with its flag unset
-        auto& readerEntry = readers.emplace_back(reader, interval);
+        auto pEntry = make_unique_psram<ReaderEntry>(std::move(reader), interval, options);
+        auto& readerEntry = *pEntry;
 
         // If an interval is specified, start the interval timer now.
         if (interval)
             readerEntry.lastReadMs.store(millis());
 
-        size_t index = readers.size() - 1;
+        if (options.ownTask)
+        {
+            if (xTaskCreatePinnedToCore(ReaderTaskEntry, options.name, NET_READER_STACK_SIZE, &readerEntry, NET_PRIORITY, &readerEntry.task, NET_CORE) != pdPASS)
+            {
+                debugE("Unable to start task for network reader %s, running it on the network task instead", options.name);
+                readerEntry.task = nullptr;
+            }
+        }
+
+        size_t index;
+        {
+            std::lock_guard<std::mutex> guard(readersMutex);
+            readers.push_back(std::move(pEntry));
+            index = readers.size() - 1;
+        }
 
         if (flag)
             FlagReader(index);
@@ -933,27 +920,240 @@ bool WriteWiFiConfig(const String& WiFi_ssid, const String& WiFi_password)
         return index;
     }
 
-    void NetworkReader::FlagReader(size_t index)
+    size_t NetworkReader::RegisterReader(const std::function<void()>& reader, unsigned long interval, bool flag, const ReaderOptions& options)
+    {
+        return AddReader([reader] { reader(); return true; }, interval, flag, options);
+    }
+
+    size_t NetworkReader::RegisterReaderWithRetry(const std::function<bool()>& reader, unsigned long interval, bool flag, const ReaderOptions& options)
+    {
+        return AddReader(reader, interval, flag, options);
+    }
+
+    NetworkReader::ReaderEntry * NetworkReader::GetEntry(size_t index) const
     {
+        std::lock_guard<std::mutex> guard(readersMutex);
+
         // Check if we received a valid reader index
-        if (index >= readers.size())
+        return index < readers.size() ? readers[index].get() : nullptr;
+    }
+
+    void NetworkReader::FlagReader(size_t index)
+    {
+        auto pEntry = GetEntry(index);
+        if (!pEntry)
             return;
 
-        readers[index].flag.store(true);
+        pEntry->flag.store(true);
 
         g_ptrSystem->TaskManager().NotifyNetworkThread();
     }
 
     void NetworkReader::CancelReader(size_t index)
     {
-        // Check if we received a valid reader index
-        if (index >= readers.size())
+        auto pEntry = GetEntry(index);
+        if (!pEntry)
             return;
 
-        auto& entry = readers[index];
-        entry.canceled.store(true);
-        entry.readInterval.store(0);
-        entry.reader = nullptr;
+        pEntry->canceled.store(true);
+        pEntry->readInterval.store(0);
+
+        // Wait for the reader to complete if it's running, before we let go of it
+        std::lock_guard<std::mutex> guard(pEntry->runMutex);
+        pEntry->reader = nullptr;
+    }
+
+    // Run
+    //
+    // Invokes a reader, keeps its statistics, and schedules a retry if it failed
+
+    void NetworkReader::Run(ReaderEntry& entry)
+    {
+        std::lock_guard<std::mutex> guard(entry.runMutex);
+
+        if (entry.canceled.load() || !entry.reader)
+            return;
+
+        unsigned long startUs = micros();
+        bool succeeded = entry.reader();
+        unsigned long elapsedUs = micros() - startUs;
+
+        entry.lastReadMs.store(millis());
+
+        auto& stats = entry.stats;
+        stats.runs++;
+        stats.lastUs = elapsedUs;
+        stats.totalUs += elapsedUs;
+        stats.maxUs = std::max(stats.maxUs, elapsedUs);
+
+        if (entry.options.budgetMs && elapsedUs / 1000 > entry.options.budgetMs)
+        {
+            stats.overruns++;
+            debugW("Network reader %s took %lu ms, its budget is %lu ms", entry.options.name, elapsedUs / 1000, entry.options.budgetMs);
+        }
+
+        if (succeeded)
+        {
+            entry.consecutiveFailures = 0;
+            entry.retryAtMs.store(0);
+            return;
+        }
+
+        stats.failures++;
+        entry.consecutiveFailures++;
+
+        unsigned long backoffMs = NETWORK_READER_MAX_BACKOFF_MS;
+        if (entry.consecutiveFailures <= 16)
+            backoffMs = std::min<unsigned long>(NETWORK_READER_MAX_BACKOFF_MS, (unsigned long)NETWORK_READER_RETRY_MS << (entry.consecutiveFailures - 1));
+
+        // A retry time of 0 means there's no retry pending, so we steer clear of that
+        entry.retryAtMs.store(std::max(1UL, millis() + backoffMs));
+
+        debugW("Network reader %s failed %zu time(s) in a row, retrying in %lu ms", entry.options.name, entry.consecutiveFailures, backoffMs);
+    }
+
+    // ReaderTaskEntry
+    //
+    // Entry point for the tasks of readers that have one of their own
+
+    void NetworkReader::ReaderTaskEntry(void * pvEntry)
+    {
+        auto& entry = *static_cast<ReaderEntry *>(pvEntry);
+
+        for (;;)
+        {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+            g_ptrSystem->NetworkReader().Run(entry);
+            entry.running.store(false);
+
+            // Let the network task know, so it can schedule the reader's next run
+            g_ptrSystem->TaskManager().NotifyNetworkThread();
+        }
+    }
+
+    unsigned long NetworkReader::RunDueReaders()
+    {
+        struct DueReader
+        {
+            ReaderEntry * pEntry;
+            unsigned long dueMs;
+        };
+
+        std::vector<ReaderEntry *> entries;
+        {
+            std::lock_guard<std::mutex> guard(readersMutex);
+            for (auto& pEntry : readers)
+                entries.push_back(pEntry.get());
+        }
+
+        std::vector<DueReader> dueReaders;
+        unsigned long now = millis();
+
+        // We wake up at least once every second
+        unsigned long holdMs = 1000;
+
+        for (auto pEntry : entries)
+        {
+            auto& entry = *pEntry;
+
+            if (entry.canceled.load() || entry.running.load())
+                continue;
+
+            auto interval = entry.readInterval.load();
+            auto lastReadMs = entry.lastReadMs.load();
+            unsigned long targetMs = lastReadMs + interval;
+            unsigned long retryAtMs = entry.retryAtMs.load();
+
+            // A reader that failed waits for its retry time, whether or not it's been flagged or its interval passed
+            if (retryAtMs)
+            {
+                if ((long)(retryAtMs - now) > 0)
+                {
+                    holdMs = std::min(holdMs, retryAtMs - now);
+                    continue;
+                }
+
+                dueReaders.push_back({ pEntry, retryAtMs });
+                continue;
+            }
+
+            // The last check captures cases where millis() returns bogus data; if the delta between now and lastReadMs is greater
+            //   than the interval then something's up with our timekeeping, so we trigger the reader just to be sure
+            if (interval && (targetMs <= now || (std::max(now, targetMs) - std::min(now, targetMs)) > interval))
+                entry.flag.store(true);
+
+            if (entry.flag.load())
+                dueReaders.push_back({ pEntry, interval ? std::min(targetMs, now) : now });
+            else if (interval)
+                holdMs = std::min(holdMs, std::min(interval, interval - (now - lastReadMs)));
+        }
+
+        // Highest priority first, and within the same priority the reader that's been due the longest
+
+        std::sort(dueReaders.begin(), dueReaders.end(), [](const DueReader& a, const DueReader& b)
+        {
+            if (a.pEntry->options.priority != b.pEntry->options.priority)
+                return a.pEntry->options.priority > b.pEntry->options.priority;
+
+            return (long)(a.dueMs - b.dueMs) < 0;
+        });
+
+        unsigned long startMs = millis();
+
+        for (auto& dueReader : dueReaders)
+        {
+            auto& entry = *dueReader.pEntry;
+
+            // Readers on their own task don't take time from the network task, so we can always start those
+            if (entry.task)
+            {
+                entry.flag.store(false);
+                entry.retryAtMs.store(0);
+                entry.running.store(true);
+                xTaskNotifyGive(entry.task);
+                continue;
+            }
+
+            // If we've run out of time for this cycle, the rest stays due and we come back right away
+            if (millis() - startMs >= NETWORK_READER_CYCLE_BUDGET_MS)
+            {
+                entry.flag.store(true);
+                holdMs = 0;
+                continue;
+            }
+
+            // Unset flag before we do the actual read. This makes that we don't miss another flag raise if it happens while reading
+            entry.flag.store(false);
+            entry.retryAtMs.store(0);
+
+            Run(entry);
+
+            // If the reader failed it has a retry scheduled now, which we need to wake up for
+            auto retryAtMs = entry.retryAtMs.load();
+            if (retryAtMs)
+                holdMs = std::min(holdMs, retryAtMs - millis());
+            else if (entry.readInterval.load())
+                holdMs = std::min(holdMs, entry.readInterval.load());
+        }
+
+        return holdMs;
+    }
+
+    void NetworkReader::LogStatistics() const
+    {
+        std::lock_guard<std::mutex> guard(readersMutex);
+
+        for (size_t i = 0; i < readers.size(); i++)
+        {
+            auto& entry = *readers[i];
+            if (entry.canceled.load())
+                continue;
+
+            const auto& stats = entry.stats;
+            debugA("%2zu %-12s runs: %zu, failures: %zu, overruns: %zu, last: %lu us, avg: %lu us, max: %lu us",
+                   i, entry.options.name, stats.runs, stats.failures, stats.overruns, stats.lastUs, stats.AverageUs(), stats.maxUs);
+        }
     }
 
 #endif // ENABLE_WIFI
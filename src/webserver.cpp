@@ -49,6 +49,15 @@ const std::map<String, CWebServer::ValueValidator> CWebServer::settingValidators
 std::vector<SettingSpec, psram_allocator<SettingSpec>> CWebServer::mySettingSpecs = {};
 std::vector<std::reference_wrapper<SettingSpec>> CWebServer::deviceSettingSpecs{};
 
+std::atomic<uint32_t> CWebServer::effectListRevision = 1;
+
+CWebServer::CachedJsonBody CWebServer::cachedEffectList{};
+std::shared_ptr<const String> CWebServer::cachedDeviceSettingSpecs{};
+std::map<size_t, CWebServer::CachedJsonBody> CWebServer::cachedEffectSettingSpecs{};
+
+// The number of effects for which we keep serialized setting specs around
+#define EFFECT_SPECS_CACHE_SIZE 8
+
 // Member function template specializations
 
 // Push param that represents a bool. Values considered true are text "true" and any whole number not equal to 0
@@ -137,7 +146,7 @@ void CWebServer::begin()
 
     // SPIFFS file requests
 
-    _server.on("/effectsConfig",         HTTP_GET,  [](AsyncWebServerRequest* pRequest) { pRequest->send(SPIFFS, EFFECTS_CONFIG_FILE,   "text/json"); });
+    _server.on("/effectsConfig",         HTTP_GET,  GetEffectsConfig);
     #if ENABLE_IMPROV_LOGGING
         _server.on(IMPROV_LOG_FILE,      HTTP_GET,  [](AsyncWebServerRequest* pRequest) { pRequest->send(SPIFFS, IMPROV_LOG_FILE,       "text/plain"); });
     #endif
@@ -167,6 +176,9 @@ void CWebServer::begin()
     _server.on("/moveEffect",            HTTP_POST, MoveEffect);
     _server.on("/copyEffect",            HTTP_POST, CopyEffect);
     _server.on("/deleteEffect",          HTTP_POST, DeleteEffect);
+    _server.on("/effectOperations",      HTTP_POST, ApplyEffectOperations);
+    _server.on("/recordFrameHashes",     HTTP_POST, RecordFrameHashes);
+    _server.on("/frameHashes",           HTTP_GET,  GetFrameHashes);
 
     _server.on("/settings/effect/specs", HTTP_GET,  GetEffectSettingSpecs);
     _server.on("/settings/effect",       HTTP_GET,  GetEffectSettings);
@@ -237,34 +249,248 @@ void CWebServer::SendBufferOverflowResponse(AsyncWebServerRequest * pRequest)
     );
 }
 
+// SendNotModifiedIfMatch
+//
+// If the request is a GET that carries the entity tag passed in its If-None-Match header, the requester already has
+//   what we would send. In that case we respond with a bodiless 304 and return true.
+
+bool CWebServer::SendNotModifiedIfMatch(AsyncWebServerRequest * pRequest, const String & etag)
+{
+    if (pRequest->method() != HTTP_GET)
+        return false;
+
+    auto header = pRequest->getHeader("If-None-Match");
+    if (!header || header->value() != etag)
+        return false;
+
+    auto response = pRequest->beginResponse(HTTP_CODE_NOT_MODIFIED);
+    response->addHeader("ETag", etag);
+    response->addHeader("Cache-Control", "no-cache");
+    AddCORSHeaderAndSendResponse(pRequest, response);
+
+    return true;
+}
+
+// SendCachedJsonResponse
+//
+// Sends a pre-serialized JSON body, optionally surrounded by a prefix and suffix that are produced per request.
+//   The body is shared with the cache it came from rather than copied, and is kept alive until it's been sent.
+//   An empty etag means the response as a whole can't be cached by the requester, so none is sent.
+
+void CWebServer::SendCachedJsonResponse(AsyncWebServerRequest * pRequest, const String & etag, std::shared_ptr<const String> body,
+                                        const String & prefix, const String & suffix)
+{
+    size_t length = prefix.length() + body->length() + suffix.length();
+
+    auto response = pRequest->beginResponse("application/json", length, [prefix, body, suffix](uint8_t * buffer, size_t maxLen, size_t index) -> size_t
+    {
+        size_t written = 0;
+
+        // The index is the offset into the whole response, so we skip the parts that have already gone out
+        for (const String * part : { &prefix, body.get(), &suffix })
+        {
+            if (written == maxLen)
+                break;
+
+            if (index >= part->length())
+            {
+                index -= part->length();
+                continue;
+            }
+
+            size_t count = std::min(maxLen - written, part->length() - index);
+            memcpy(buffer + written, part->c_str() + index, count);
+
+            written += count;
+            index = 0;
+        }
+
+        return written;
+    });
+
+    if (!etag.isEmpty())
+    {
+        response->addHeader("ETag", etag);
+        response->addHeader("Cache-Control", "no-cache");
+    }
+    AddCORSHeaderAndSendResponse(pRequest, response);
+}
+
+// BeginChunkedJsonResponse
+//
+// Creates a response that is sent using chunked transfer encoding, with its body produced piece by piece by the
+//   producer passed. Only the piece that's being sent is kept in memory, so large responses don't need to be built
+//   in one JSON document first. Note that the producer is called after the request handler has returned, so it must
+//   own or keep alive whatever it needs.
+
+AsyncWebServerResponse * CWebServer::BeginChunkedJsonResponse(AsyncWebServerRequest * pRequest, JsonChunkProducer producer)
+{
+    struct ChunkState
+    {
+        JsonChunkProducer producer;
+        String piece;
+        size_t offset = 0;
+        bool lastPiece = false;
+    };
+
+    auto state = std::make_shared<ChunkState>();
+    state->producer = std::move(producer);
+
+    return pRequest->beginChunkedResponse("application/json", [state](uint8_t * buffer, size_t maxLen, size_t index) -> size_t
+    {
+        size_t length = 0;
+
+        while (length < maxLen)
+        {
+            // If we've sent all of the current piece, get the next one, if there is one
+            if (state->offset >= state->piece.length())
+            {
+                if (state->lastPiece)
+                    break;
+
+                state->offset = 0;
+                state->lastPiece = !state->producer(state->piece);
+                continue;
+            }
+
+            size_t count = std::min(maxLen - length, state->piece.length() - state->offset);
+            memcpy(buffer + length, state->piece.c_str() + state->offset, count);
+
+            length += count;
+            state->offset += count;
+        }
+
+        // Returning 0 ends the response
+        return length;
+    });
+}
+
+// SerializeEffectList
+//
+// Serializes the effect array of the effect list response, without the surrounding brackets
+
+std::shared_ptr<const String> CWebServer::SerializeEffectList()
+{
+    auto body = std::make_shared<String>();
+    auto& effectManager = g_ptrSystem->EffectManager();
+
+    for (size_t i = 0; i < effectManager.EffectCount(); i++)
+    {
+        auto effectDoc = CreateJsonDocument();
+
+        // The name is fetched through the effect manager, which reads it under its lock
+        effectDoc["name"]    = effectManager.GetEffectName(i);
+        effectDoc["enabled"] = effectManager.IsEffectEnabled(i);
+        effectDoc["core"]    = effectManager.EffectsList()[i].IsCoreEffect();
+
+        String effectText;
+        serializeJson(effectDoc, effectText);
+
+        if (!body->isEmpty())
+            *body += ',';
+        *body += effectText;
+    }
+
+    return body;
+}
+
+// GetEffectListText
+//
+// The effect array is taken from cache as long as the effect list hasn't changed. The overall properties before
+//   it are cheap and include the time remaining for the current effect, so those are produced for every request.
+//   That countdown changes all the time, so unlike our other cached responses this one doesn't get an ETag.
+
 void CWebServer::GetEffectListText(AsyncWebServerRequest * pRequest)
 {
     debugV("GetEffectListText");
 
-    auto response = new AsyncJsonResponse();
-    auto& j = response->getRoot();
     auto& effectManager = g_ptrSystem->EffectManager();
 
-    j["currentEffect"]         = effectManager.GetCurrentEffectIndex();
-    j["millisecondsRemaining"] = effectManager.GetTimeRemainingForCurrentEffect();
-    j["eternalInterval"]       = effectManager.IsIntervalEternal();
-    j["effectInterval"]        = effectManager.GetInterval();
+    uint32_t listRevision = effectListRevision;
+
+    if (!cachedEffectList.body || cachedEffectList.revision != listRevision)
+        cachedEffectList = { listRevision, SerializeEffectList() };
+
+    // Start with the overall properties, and leave the object open for the effect array that follows
+    auto headerDoc = CreateJsonDocument();
+
+    headerDoc["currentEffect"]         = effectManager.GetCurrentEffectIndex();
+    headerDoc["millisecondsRemaining"] = effectManager.GetTimeRemainingForCurrentEffect();
+    headerDoc["eternalInterval"]       = effectManager.IsIntervalEternal();
+    headerDoc["effectInterval"]        = effectManager.GetInterval();
+
+    String header;
+    serializeJson(headerDoc, header);
+    header.remove(header.length() - 1);
+    header += ",\"Effects\":[";
+
+    SendCachedJsonResponse(pRequest, String(), cachedEffectList.body, header, "]}");
+}
+
+// GetEffectsConfig
+//
+// The effect configuration is persisted in a binary format (see effectstore.h), so we export it as JSON from
+//   the EffectManager itself. The layout is the same as that of the effects JSON file earlier versions wrote.
+//   This is by far the largest response we send, so it goes out one effect at a time.
+
+void CWebServer::GetEffectsConfig(AsyncWebServerRequest * pRequest)
+{
+    debugV("GetEffectsConfig");
+
+    auto& effectManager = g_ptrSystem->EffectManager();
+    auto headerDoc = CreateJsonDocument();
+
+    headerDoc[PTY_VERSION]      = JSON_FORMAT_VERSION;
+    headerDoc["ivl"]            = effectManager.GetInterval();
+    headerDoc[PTY_PROJECT]      = PROJECT_NAME;
+    headerDoc[PTY_EFFECTSETVER] = effectManager.GetEffectSetVersion();
+
+    String header;
+    serializeJson(headerDoc, header);
+    header.remove(header.length() - 1);
+    header += ",\"efs\":[";
+
+    size_t effectCount = effectManager.EffectCount();
+    size_t nextIndex = 0;
+    bool headerSent = false;
+    bool firstEffect = true;
 
-    for (const auto& effect : effectManager.EffectsList())
+    auto response = BeginChunkedJsonResponse(pRequest, [header, effectCount, nextIndex, headerSent, firstEffect](String& piece) mutable
     {
-        auto effectDoc = CreateJsonDocument();
+        if (!headerSent)
+        {
+            piece = std::move(header);
+            headerSent = true;
+            return true;
+        }
 
-        effectDoc["name"]    = effect->FriendlyName();
-        effectDoc["enabled"] = effect->IsEnabled();
-        effectDoc["core"]    = effect->IsCoreEffect();
+        size_t index = nextIndex++;
 
-        if (!j["Effects"].add(effectDoc))
+        if (index >= effectCount)
         {
-            debugV("JSON response buffer overflow!");
-            SendBufferOverflowResponse(pRequest);
-            return;
+            piece = "]}";
+            return false;
         }
-    }
+
+        auto effectDoc = CreateJsonDocument();
+        auto effectObject = effectDoc.to<JsonObject>();
+
+        // If an effect can't be serialized (or was deleted in the meantime) we leave it out rather than break the document
+        if (!g_ptrSystem->EffectManager().SerializeEffectToJSON(index, effectObject))
+        {
+            debugW("Could not serialize effect %zu for effects config response", index);
+            piece = String();
+            return true;
+        }
+
+        serializeJson(effectDoc, piece);
+        if (!firstEffect)
+            piece = "," + piece;
+
+        firstEffect = false;
+
+        return true;
+    });
 
     AddCORSHeaderAndSendResponse(pRequest, response);
 }
@@ -310,6 +536,14 @@ void CWebServer::GetStatistics(AsyncWebServerRequest * pRequest, StatisticsType
         j["CPU_USED"]              = taskManager.GetCPUUsagePercent();
         j["CPU_USED_CORE0"]        = taskManager.GetCPUUsagePercent(0);
         j["CPU_USED_CORE1"]        = taskManager.GetCPUUsagePercent(1);
+
+        auto& writerStats = g_ptrSystem->JSONWriter().GetStatistics();
+
+        j["PERSIST_FLAGS"]         = writerStats.flagsRaised.load();
+        j["PERSIST_COMMITS"]       = writerStats.commits.load();
+        j["PERSIST_WRITES"]        = writerStats.filesWritten.load();
+        j["PERSIST_UNCHANGED"]     = writerStats.filesUnchanged.load();
+        j["PERSIST_BYTES"]         = writerStats.bytesWritten.load();
     }
 
     AddCORSHeaderAndSendResponse(pRequest, response);
@@ -388,7 +622,7 @@ void CWebServer::DeleteEffect(AsyncWebServerRequest * pRequest)
         return;
     }
 
-    if (index < g_ptrSystem->EffectManager().EffectCount() && g_ptrSystem->EffectManager().EffectsList()[index]->IsCoreEffect())
+    if (index < g_ptrSystem->EffectManager().EffectCount() && g_ptrSystem->EffectManager().EffectsList()[index].IsCoreEffect())
     {
         AddCORSHeaderAndSendBadRequest(pRequest, "Can't delete core effect");
         return;
@@ -398,6 +632,125 @@ void CWebServer::DeleteEffect(AsyncWebServerRequest * pRequest)
     AddCORSHeaderAndSendOKResponse(pRequest);
 }
 
+// ApplyEffectOperations
+//
+// Applies a batch of effect list changes that is passed as a JSON array in the "operations" parameter, like:
+//   [{"op":"move","effectIndex":3,"newIndex":0},{"op":"disable","effectIndex":5}]
+//   Supported ops are "enable", "disable" and "move". The batch is applied as a whole or not at all, and the effect
+//   list is saved and reported as changed only once.
+
+void CWebServer::ApplyEffectOperations(AsyncWebServerRequest * pRequest)
+{
+    debugV("ApplyEffectOperations");
+
+    if (!pRequest->hasParam("operations", true, false))
+    {
+        AddCORSHeaderAndSendBadRequest(pRequest, "No operations");
+        return;
+    }
+
+    auto jsonDoc = CreateJsonDocument();
+
+    if (deserializeJson(jsonDoc, pRequest->getParam("operations", true, false)->value()) || !jsonDoc.is<JsonArrayConst>())
+    {
+        AddCORSHeaderAndSendBadRequest(pRequest, "Malformed operations");
+        return;
+    }
+
+    using Operation = EffectManager::EffectListOperation;
+    std::vector<Operation> operations;
+
+    for (auto operationObject : jsonDoc.as<JsonArrayConst>())
+    {
+        String op = operationObject["op"] | "";
+        Operation operation;
+
+        if (op == "enable")
+            operation.type = Operation::Type::Enable;
+        else if (op == "disable")
+            operation.type = Operation::Type::Disable;
+        else if (op == "move" && operationObject["newIndex"].is<size_t>())
+        {
+            operation.type = Operation::Type::Move;
+            operation.newIndex = operationObject["newIndex"];
+        }
+        else
+        {
+            AddCORSHeaderAndSendBadRequest(pRequest, "Invalid operation");
+            return;
+        }
+
+        if (!operationObject["effectIndex"].is<size_t>())
+        {
+            AddCORSHeaderAndSendBadRequest(pRequest, "Invalid operation");
+            return;
+        }
+
+        operation.index = operationObject["effectIndex"];
+        operations.push_back(operation);
+    }
+
+    if (!g_ptrSystem->EffectManager().ApplyEffectListOperations(operations))
+    {
+        AddCORSHeaderAndSendBadRequest(pRequest, "Invalid effect index");
+        return;
+    }
+
+    AddCORSHeaderAndSendOKResponse(pRequest);
+}
+
+// RecordFrameHashes
+//
+// Starts replaying an effect with a fixed clock and seed, recording a hash of every frame. The result can be
+//   fetched from /frameHashes once it's done, and compared with that of another firmware build.
+
+void CWebServer::RecordFrameHashes(AsyncWebServerRequest * pRequest)
+{
+    debugV("RecordFrameHashes");
+
+    auto effectIndex = GetEffectIndexFromParam(pRequest, true);
+    size_t seed = 1;
+    size_t frames = 300;
+
+    PushPostParamIfPresent<size_t>(pRequest, "seed", SET_VALUE(seed = value));
+    PushPostParamIfPresent<size_t>(pRequest, "frames", SET_VALUE(frames = value));
+
+    if (effectIndex < 0 || !g_ptrSystem->EffectManager().RequestFrameHashRecording(effectIndex, seed, frames))
+    {
+        AddCORSHeaderAndSendBadRequest(pRequest, "Invalid effect index or frame count");
+        return;
+    }
+
+    AddCORSHeaderAndSendOKResponse(pRequest);
+}
+
+void CWebServer::GetFrameHashes(AsyncWebServerRequest * pRequest)
+{
+    debugV("GetFrameHashes");
+
+    bool pending;
+    auto recording = g_ptrSystem->EffectManager().GetFrameHashRecording(pending);
+
+    auto response = new AsyncJsonResponse();
+    auto& j = response->getRoot();
+
+    j["pending"] = pending;
+
+    if (recording)
+    {
+        j["effectIndex"] = recording->effectIndex;
+        j["seed"]        = recording->seed;
+        j["frames"]      = recording->frameCount;
+        j["failed"]      = recording->failed;
+
+        auto hashes = j["hashes"].to<JsonArray>();
+        for (auto hash : recording->hashes)
+            hashes.add(hash);
+    }
+
+    AddCORSHeaderAndSendResponse(pRequest, response);
+}
+
 void CWebServer::NextEffect(AsyncWebServerRequest * pRequest)
 {
     debugV("NextEffect");
@@ -412,16 +765,19 @@ void CWebServer::PreviousEffect(AsyncWebServerRequest * pRequest)
     AddCORSHeaderAndSendOKResponse(pRequest);
 }
 
-void CWebServer::SendSettingSpecsResponse(AsyncWebServerRequest * pRequest, const std::vector<std::reference_wrapper<SettingSpec>> & settingSpecs)
+// SerializeSettingSpecs
+//
+// Serializes setting specs into a JSON array. Specs are serialized one at a time, so we never need a JSON document
+//   that holds all of them.
+
+std::shared_ptr<const String> CWebServer::SerializeSettingSpecs(const std::vector<std::reference_wrapper<SettingSpec>> & settingSpecs)
 {
-    auto response = new AsyncJsonResponse();
-    auto jsonArray = response->getRoot().to<JsonArray>();
+    auto body = std::make_shared<String>("[");
+    bool firstSpec = true;
 
-    for (const auto& specWrapper : settingSpecs)
+    for (auto& specWrapper : settingSpecs)
     {
         const auto& spec = specWrapper.get();
-        auto specObject = jsonArray.add<JsonObject>();
-
         auto jsonDoc = CreateJsonDocument();
 
         jsonDoc["name"] = spec.Name;
@@ -453,15 +809,25 @@ void CWebServer::SendSettingSpecsResponse(AsyncWebServerRequest * pRequest, cons
                 break;
         }
 
-        if (jsonDoc.overflowed() || !specObject.set(jsonDoc.as<JsonObjectConst>()))
+        if (jsonDoc.overflowed())
         {
-            debugV("JSON response buffer overflow!");
-            SendBufferOverflowResponse(pRequest);
-            return;
+            debugW("JSON buffer overflow serializing setting spec %s", spec.Name);
+            continue;
         }
+
+        String specText;
+        serializeJson(jsonDoc, specText);
+
+        if (!firstSpec)
+            *body += ',';
+        *body += specText;
+
+        firstSpec = false;
     }
 
-    AddCORSHeaderAndSendResponse(pRequest, response);
+    *body += ']';
+
+    return body;
 }
 
 const std::vector<std::reference_wrapper<SettingSpec>> & CWebServer::LoadDeviceSettingSpecs()
@@ -483,9 +849,23 @@ const std::vector<std::reference_wrapper<SettingSpec>> & CWebServer::LoadDeviceS
     return deviceSettingSpecs;
 }
 
+// The device setting specs are fixed for the firmware we run, so we serialize them once and use the CRC of the
+//   result as the entity tag
+
 void CWebServer::GetSettingSpecs(AsyncWebServerRequest * pRequest)
 {
-    SendSettingSpecsResponse(pRequest, LoadDeviceSettingSpecs());
+    static String etag;
+
+    if (!cachedDeviceSettingSpecs)
+    {
+        cachedDeviceSettingSpecs = SerializeSettingSpecs(LoadDeviceSettingSpecs());
+        etag = str_sprintf("\"d%08x\"", (unsigned) esp_rom_crc32_le(0, (const uint8_t *) cachedDeviceSettingSpecs->c_str(), cachedDeviceSettingSpecs->length()));
+    }
+
+    if (SendNotModifiedIfMatch(pRequest, etag))
+        return;
+
+    SendCachedJsonResponse(pRequest, etag, cachedDeviceSettingSpecs);
 }
 
 // Responds with current config, excluding any sensitive values
@@ -493,15 +873,31 @@ void CWebServer::GetSettings(AsyncWebServerRequest * pRequest)
 {
     debugV("GetSettings");
 
-    auto response = new AsyncJsonResponse();
-    response->addHeader("Server", "NightDriverStrip");
-    auto root = response->getRoot();
-    JsonObject jsonObject = root.to<JsonObject>();
+    auto& deviceConfig = g_ptrSystem->DeviceConfig();
+    String etag = str_sprintf("\"s%u-%u\"", (unsigned) deviceConfig.GetRevision(), (unsigned) g_ptrSystem->EffectManager().GetInterval());
+
+    if (SendNotModifiedIfMatch(pRequest, etag))
+        return;
+
+    auto jsonDoc = CreateJsonDocument();
+    JsonObject jsonObject = jsonDoc.to<JsonObject>();
 
     // We get the serialized JSON for the device config, without any sensitive values
-    g_ptrSystem->DeviceConfig().SerializeToJSON(jsonObject, false);
+    deviceConfig.SerializeToJSON(jsonObject, false);
     jsonObject["effectInterval"] = g_ptrSystem->EffectManager().GetInterval();
 
+    // Only the serialized text is kept until it's been sent; the document itself is released right away
+    auto settings = std::make_shared<String>();
+    serializeJson(jsonDoc, *settings);
+
+    auto response = BeginChunkedJsonResponse(pRequest, [settings](String& piece)
+    {
+        piece = std::move(*settings);
+        return false;
+    });
+
+    response->addHeader("ETag", etag);
+    response->addHeader("Cache-Control", "no-cache");
     AddCORSHeaderAndSendResponse(pRequest, response);
 }
 
@@ -523,6 +919,7 @@ void CWebServer::SetSettingsIfPresent(AsyncWebServerRequest * pRequest)
     PushPostParamIfPresent<bool>(pRequest, DeviceConfig::UseCelsiusTag, SET_VALUE(deviceConfig.SetUseCelsius(value)));
     PushPostParamIfPresent<String>(pRequest, DeviceConfig::NTPServerTag, SET_VALUE(deviceConfig.SetNTPServer(value)));
     PushPostParamIfPresent<bool>(pRequest, DeviceConfig::RememberCurrentEffectTag, SET_VALUE(deviceConfig.SetRememberCurrentEffect(value)));
+    PushPostParamIfPresent<bool>(pRequest, DeviceConfig::SyncEffectsTag, SET_VALUE(deviceConfig.SetSyncEffects(value)));
     PushPostParamIfPresent<int>(pRequest, DeviceConfig::PowerLimitTag, SET_VALUE(deviceConfig.SetPowerLimit(value)));
     PushPostParamIfPresent<int>(pRequest, DeviceConfig::BrightnessTag, SET_VALUE(deviceConfig.SetBrightness(value)));
 
@@ -554,31 +951,69 @@ void CWebServer::SetSettings(AsyncWebServerRequest * pRequest)
 
 bool CWebServer::CheckAndGetSettingsEffect(AsyncWebServerRequest * pRequest, std::shared_ptr<LEDStripEffect> & effect, bool post)
 {
-    auto effectsList = g_ptrSystem->EffectManager().EffectsList();
+    auto& effectManager = g_ptrSystem->EffectManager();
     auto effectIndex = GetEffectIndexFromParam(pRequest, post);
 
-    if (effectIndex < 0 || effectIndex >= effectsList.size())
+    if (effectIndex < 0 || effectIndex >= effectManager.EffectCount())
     {
         AddCORSHeaderAndSendOKResponse(pRequest);
 
         return false;
     }
 
-    effect = effectsList[effectIndex];
+    // Most effects aren't loaded when they're not playing, so this may instantiate it
+    effect = effectManager.GetEffect(effectIndex);
+
+    if (!effect)
+    {
+        AddCORSHeaderAndSendBadRequest(pRequest, "Could not load effect");
+
+        return false;
+    }
 
     return true;
 }
 
+// Effect setting specs are cached per effect index, and invalidated whenever the effect list changes. If we have
+//   the specs in cache, we also don't need to load the effect to respond.
+
 void CWebServer::GetEffectSettingSpecs(AsyncWebServerRequest * pRequest)
 {
+    auto& effectManager = g_ptrSystem->EffectManager();
+    auto effectIndex = GetEffectIndexFromParam(pRequest);
+
+    if (effectIndex < 0 || effectIndex >= effectManager.EffectCount())
+    {
+        AddCORSHeaderAndSendOKResponse(pRequest);
+        return;
+    }
+
+    uint32_t listRevision = effectListRevision;
+    String etag = str_sprintf("\"f%d-%u-%ld\"", effectManager.GetEffectSetVersion(), (unsigned) listRevision, effectIndex);
+
+    if (SendNotModifiedIfMatch(pRequest, etag))
+        return;
+
+    auto cached = cachedEffectSettingSpecs.find(effectIndex);
+    if (cached != cachedEffectSettingSpecs.end() && cached->second.revision == listRevision)
+    {
+        SendCachedJsonResponse(pRequest, etag, cached->second.body);
+        return;
+    }
+
     std::shared_ptr<LEDStripEffect> effect;
 
     if (!CheckAndGetSettingsEffect(pRequest, effect))
         return;
 
-    auto settingSpecs = effect->GetSettingSpecs();
+    // Keep the cache small; if it's full we simply start over
+    if (cachedEffectSettingSpecs.size() >= EFFECT_SPECS_CACHE_SIZE && cached == cachedEffectSettingSpecs.end())
+        cachedEffectSettingSpecs.clear();
 
-    SendSettingSpecsResponse(pRequest, settingSpecs);
+    auto& entry = cachedEffectSettingSpecs[effectIndex];
+    entry = { listRevision, SerializeSettingSpecs(effect->GetSettingSpecs()) };
+
+    SendCachedJsonResponse(pRequest, etag, entry.body);
 }
 
 void CWebServer::SendEffectSettingsResponse(AsyncWebServerRequest * pRequest, std::shared_ptr<LEDStripEffect> & effect)
@@ -632,7 +1067,11 @@ void CWebServer::SetEffectSettings(AsyncWebServerRequest * pRequest)
         return;
 
     if (ApplyEffectSettings(pRequest, effect))
+    {
+        // Settings can include the effect's name, so anything we cached about the effect list may be outdated
+        effectListRevision++;
         SaveEffectManagerConfig();
+    }
 
     SendEffectSettingsResponse(pRequest, effect);
 }
@@ -727,4 +1166,4 @@ void CWebServer::Reset(AsyncWebServerRequest * pRequest)
         debugW("Resetting device at API request!");
         throw std::runtime_error("Resetting device at API request");
     }
-}
\ No newline at end of file
+}
\ No newline at end of file